@@ -5,20 +5,142 @@
 #include <eosio/eosio.hpp>
 #include <eosio/time.hpp>
 #include <eosio/singleton.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/varint.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "utility.hpp"
+#include "profile.hpp"
 
 using namespace std;
 using namespace eosio;
 using namespace utility;
 
+// host function of nodeos with action return values, cdt 1.6.1 does not declare it
+extern "C" {
+    __attribute__((eosio_wasm_import))
+    void set_action_return_value(void* return_value, size_t size);
+}
+
 CONTRACT dgoods: public contract {
     public:
         using contract::contract;
 
         const int WEEK_SEC = 3600*24*7;
+        // rev_split_bps is out of BASIS_POINTS of the sale amount
+        static constexpr int64_t BASIS_POINTS = 10000;
+        // asks are in EOS and at least 0.02 EOS
+        static constexpr uint8_t EOS_PRECISION = 4;
+        static constexpr int64_t MIN_ASK_AMOUNT = 2 * ipow10( EOS_PRECISION - 2 );
+        // batch_id passed by callers that are not acting on an ask
+        static constexpr uint64_t UNLOCKED = numeric_limits<uint64_t>::max();
+        // nft rows store serial_number as varuint32, ids and serial numbers stay at or below this
+        static constexpr uint64_t MAX_TOKEN_NUMBER = numeric_limits<uint32_t>::max() - 1;
+        // asks::category_name_id of an ask holding more than one token type
+        static constexpr uint64_t MIXED_TYPES = numeric_limits<uint64_t>::max();
+        // tables converted by migrate in order, new steps are appended so a contract that is done
+        // with the earlier ones resumes at the first new step
+        static constexpr name MIGRATION_STEPS[] = { "asks"_n, "lockednfts"_n, "dgood"_n, "dgoodstats"_n };
+        static constexpr uint32_t MIGRATION_STEP_COUNT = std::size( MIGRATION_STEPS );
+        // RAM nodeos bills on top of the serialized row, per row and per secondary index entry
+        static constexpr uint64_t ROW_OVERHEAD = 108;
+        static constexpr uint64_t IDX64_OVERHEAD = 128;
+        static constexpr uint64_t IDX128_OVERHEAD = 136;
+
+        // key of the byownertype indices, all tokens of one type held by owner share it
+        static constexpr uint128_t owner_type_key(const name& owner, const uint64_t& category_name_id) {
+            return ( static_cast<uint128_t>( owner.value ) << 64 ) | category_name_id;
+        }
+
+        // key of the bytypeserial indices, orders the tokens of one type by serial_number
+        static constexpr uint128_t type_serial_key(const uint64_t& category_name_id, const uint64_t& serial_number) {
+            return ( static_cast<uint128_t>( category_name_id ) << 64 ) | serial_number;
+        }
+
+        // key of the byhash index, the first 8 bytes of the sha256 of a uri, uris sharing it are told
+        // apart by comparing the uri
+        static uint64_t uri_hash(const string& uri) {
+            auto bytes = sha256( uri.data(), uri.size() ).extract_as_byte_array();
+            uint64_t hash = 0;
+            for ( int i = 0; i < 8; i++ ) {
+                hash |= uint64_t( bytes[i] ) << ( 8 * i );
+            }
+            return hash;
+        }
+
+        // key of the bytypeprice index, orders the asks of one type by price per token
+        static constexpr uint128_t type_price_key(const uint64_t& category_name_id, const uint64_t& unit_price) {
+            return ( static_cast<uint128_t>( category_name_id ) << 64 ) | unit_price;
+        }
+
+        // one credit of airdropft
+        struct ftrecipient {
+            name  to;
+            asset quantity;
+        };
+
+        // one recipient of transfernfts
+        struct nftrecipient {
+            name             to;
+            vector<uint64_t> dgood_ids;
+        };
+
+        // a token or, when last_id is past id, a range of tokens returned by getowned
+        struct ownedtoken {
+            uint64_t id;
+            uint64_t last_id;
+            uint64_t serial_number;
+            name     category;
+            name     token_name;
+            bool     burnable;
+            bool     sellable;
+            bool     transferable;
+            bool     locked;
+            // base_uri followed by relative_uri
+            string   uri;
+        };
+
+        // first entry of the next getowned page, table is nft, dgoodranges or dgood and id the first
+        // id of the entry, category_name_id is 0 for dgood
+        struct ownedcursor {
+            name     table;
+            uint64_t category_name_id;
+            uint64_t id;
+        };
+
+        // cursor is passed for the next page, empty on the last page
+        struct ownedpage {
+            vector<ownedtoken>          tokens;
+            std::optional<ownedcursor>  cursor;
+        };
+
+        struct ownedbalance {
+            name  category;
+            name  token_name;
+            asset amount;
+        };
+
+        // a listing returned by getasks, category and token_name are empty for mixed listings
+        struct listing {
+            uint64_t         batch_id;
+            vector<uint64_t> dgood_ids;
+            asset            amount;
+            time_point_sec   expiration;
+            name             category;
+            name             token_name;
+        };
+
+        // cursor is the batch_id to pass for the next page, empty on the last page
+        struct askpage {
+            vector<listing>           asks;
+            std::optional<uint64_t>   cursor;
+        };
 
         dgoods(name receiver, name code, datastream<const char*> ds)
             : contract(receiver, code, ds) {}
@@ -45,6 +167,13 @@ CONTRACT dgoods: public contract {
                      const string& relative_uri,
                      const string& memo);
 
+        ACTION issuerange(const name& to,
+                          const name& category,
+                          const name& token_name,
+                          const asset& quantity,
+                          const string& relative_uri,
+                          const string& memo);
+
         ACTION burnnft(const name& owner,
                        const vector<uint64_t>& dgood_ids);
 
@@ -59,6 +188,30 @@ CONTRACT dgoods: public contract {
                            const vector<uint64_t>& dgood_ids,
                            const string& memo);
 
+        ACTION transfernfts(const name& from,
+                            const vector<nftrecipient>& recipients,
+                            const string& memo);
+
+        // from_serial of the next call, empty once every token from from_serial on was visited
+        [[eosio::action]] std::optional<uint64_t> burntype(const name& category,
+                                                           const name& token_name,
+                                                           const uint64_t& from_serial,
+                                                           const uint64_t& max_rows);
+
+        // from_serial of the next call, empty once every token from from_serial on was visited
+        [[eosio::action]] std::optional<uint64_t> seturis(const name& category,
+                                                          const name& token_name,
+                                                          const string& relative_uri,
+                                                          const uint64_t& from_serial,
+                                                          const uint64_t& max_rows);
+
+        ACTION trackholders(const name& category,
+                            const name& token_name);
+
+        ACTION addholders(const name& category,
+                          const name& token_name,
+                          const vector<name>& owners);
+
         ACTION transferft(const name& from,
                           const name& to,
                           const name& category,
@@ -66,6 +219,12 @@ CONTRACT dgoods: public contract {
                           const asset& quantity,
                           const string& memo);
 
+        ACTION airdropft(const name& from,
+                         const name& category,
+                         const name& token_name,
+                         const vector<ftrecipient>& recipients,
+                         const string& memo);
+
         ACTION listsalenft(const name& seller,
                            const vector<uint64_t>& dgood_ids,
                            const asset& net_sale_amount);
@@ -73,8 +232,56 @@ CONTRACT dgoods: public contract {
         ACTION closesalenft(const name& seller,
                             const uint64_t& batch_id);
 
-        ACTION logcall(const uint64_t& dgood_id);
+        ACTION sweepexpired(const uint64_t& max_rows);
+
+        ACTION setaccrual(const bool& accrue);
+
+        ACTION withdraw(const name& account);
+
+        ACTION settle(const name& from,
+                      const uint64_t& max_rows);
+
+        ACTION queuejob(const name& owner,
+                        const name& type,
+                        const name& to,
+                        const vector<uint64_t>& dgood_ids,
+                        const uint64_t& first_id,
+                        const uint64_t& last_id);
+
+        ACTION process(const uint64_t& job_id,
+                       const uint64_t& max_steps);
+
+        ACTION canceljob(const name& owner,
+                         const uint64_t& job_id);
+
+        ACTION logcall(const uint64_t& first_id,
+                       const uint64_t& last_id);
+
+        ACTION migrate(const uint64_t& max_rows);
+
+        ACTION migrateacct(const name& owner,
+                           const uint64_t& max_rows);
+
+        // queries, they write nothing and return their result as the action return value
+        [[eosio::action]] ownedpage getowned(const name& owner,
+                                             const std::optional<ownedcursor>& cursor,
+                                             const uint32_t& limit);
+
+        [[eosio::action]] vector<ownedbalance> getbalances(const name& owner);
+
+        [[eosio::action]] askpage getasks(const name& seller,
+                                          const std::optional<uint64_t>& cursor,
+                                          const uint32_t& limit);
+
+        // scope is self, EOS owed from sales while accrue_proceeds is set, paid by withdraw or settle
+        TABLE proceeds {
+            name account;
+            asset amount;
 
+            uint64_t primary_key() const { return account.value; }
+        };
+
+        // v1 locks, drained by migrate
         TABLE lockednfts {
             uint64_t dgood_id;
 
@@ -89,9 +296,16 @@ CONTRACT dgoods: public contract {
             name seller;
             asset amount;
             time_point_sec expiration;
+            // type of every token in dgood_ids or MIXED_TYPES, missing on asks listed by v1
+            binary_extension<uint64_t> category_name_id;
 
             uint64_t primary_key() const { return batch_id; }
             uint64_t get_seller() const { return seller.value; }
+            uint64_t get_expiration() const { return expiration.sec_since_epoch(); }
+            uint128_t get_type_price() const {
+                return type_price_key( category_name_id.has_value() ? category_name_id.value() : MIXED_TYPES,
+                                       amount.amount / dgood_ids.size() );
+            }
         };
 
         TABLE tokenconfigs {
@@ -99,6 +313,9 @@ CONTRACT dgoods: public contract {
             string version;
             symbol_code symbol;
             uint64_t category_name_id;
+            binary_extension<uint64_t> next_dgood_id;
+            // sale proceeds are credited to proceeds instead of sent, see setaccrual
+            binary_extension<bool> accrue_proceeds;
         };
 
         TABLE categoryinfo {
@@ -123,11 +340,48 @@ CONTRACT dgoods: public contract {
             asset    issued_supply;
             double   rev_split;
             string   base_uri;
+            // rev_split in basis points, missing on rows written before it existed
+            binary_extension<uint16_t> rev_split_bps;
+            // number of holders, missing unless the issuer opted in with trackholders
+            binary_extension<uint64_t> holder_count;
 
             uint64_t primary_key() const { return token_name.value; }
+            uint16_t get_rev_split_bps() const {
+                return rev_split_bps.has_value() ? rev_split_bps.value() : to_basis_points( rev_split );
+            }
         };
 
-        // scope is self
+        EOSLIB_SERIALIZE( dgoodstats, (fungible)(burnable)(sellable)(transferable)(issuer)(rev_partner)(token_name)
+                                      (category_name_id)(max_supply)(current_supply)(issued_supply)(rev_split)
+                                      (base_uri)(rev_split_bps)(holder_count) )
+
+        // scope is self, the dgoodstats fields read for every token moved, fixed size, written by
+        // create and modified only by trackholders, supplies and metadata stay in dgoodstats
+        TABLE typestats {
+            uint64_t category_name_id;
+            bool     fungible;
+            bool     burnable;
+            bool     sellable;
+            bool     transferable;
+            // holders and holder_count are kept, complete once the type has no holderfill row
+            bool     holders_tracked;
+            name     rev_partner;
+            uint16_t rev_split_bps;
+            symbol   supply_symbol;
+
+            uint64_t primary_key() const { return category_name_id; }
+        };
+
+        // scope is self, category and token_name of every category_name_id in use
+        TABLE tokentypes {
+            uint64_t category_name_id;
+            name category;
+            name token_name;
+
+            uint64_t primary_key() const { return category_name_id; }
+        };
+
+        // scope is self, v1 layout of nfts, rows are converted when touched or by migrate
         TABLE dgood {
             uint64_t id;
             uint64_t serial_number;
@@ -138,12 +392,60 @@ CONTRACT dgoods: public contract {
 
             uint64_t primary_key() const { return id; }
             uint64_t get_owner() const { return owner.value; }
-
         };
 
         EOSLIB_SERIALIZE( dgood, (id)(serial_number)(owner)(category)(token_name)(relative_uri) )
 
-        // scope is owner
+        // scope is self
+        TABLE nft {
+            uint64_t id;
+            unsigned_int serial_number;
+            name owner;
+            unsigned_int category_name_id;
+            // 1 while an ask holds the token, 0 when it is not listed, listing never grows the row
+            // its payer may not have authorized
+            unsigned_int lock;
+            // relative_uri in uris, 0 when the token has none
+            unsigned_int uri_id;
+
+            uint64_t primary_key() const { return id; }
+            uint128_t get_owner_type() const { return owner_type_key( owner, category_name_id.value ); }
+            uint128_t get_type_serial() const { return type_serial_key( category_name_id.value, serial_number.value ); }
+        };
+
+        EOSLIB_SERIALIZE( nft, (id)(serial_number)(owner)(category_name_id)(lock)(uri_id) )
+
+        // scope is self
+        // ids first_id..last_id issued by issuerange that have no nft row yet
+        TABLE dgoodranges {
+            uint64_t last_id;
+            uint64_t first_id;
+            unsigned_int serial_number;
+            name owner;
+            unsigned_int category_name_id;
+            unsigned_int uri_id;
+
+            uint64_t primary_key() const { return last_id; }
+            uint128_t get_owner_type() const { return owner_type_key( owner, category_name_id.value ); }
+            uint128_t get_type_serial() const { return type_serial_key( category_name_id.value, serial_number.value ); }
+        };
+
+        EOSLIB_SERIALIZE( dgoodranges, (last_id)(first_id)(serial_number)(owner)(category_name_id)(uri_id) )
+
+        // scope is self, a relative_uri stored once for every nft and dgoodranges row using it,
+        // refs counts those rows and the row is erased with the last of them
+        TABLE uris {
+            uint64_t uri_id;
+            string uri;
+            // uri_hash of uri
+            uint64_t hash;
+            uint64_t refs;
+
+            uint64_t primary_key() const { return uri_id; }
+            uint64_t get_hash() const { return hash; }
+        };
+
+        // scope is owner, v1 layout of balances, rows are converted when touched or by migrateacct
         TABLE accounts {
             uint64_t category_name_id;
             name category;
@@ -153,29 +455,209 @@ CONTRACT dgoods: public contract {
             uint64_t primary_key() const { return category_name_id; }
         };
 
-        using config_index = singleton< "tokenconfigs"_n, tokenconfigs >;
+        // scope is owner, amount has the precision of the token type's max_supply
+        TABLE balances {
+            unsigned_int category_name_id;
+            int64_t amount;
 
-        using account_index = multi_index< "accounts"_n, accounts >;
+            uint64_t primary_key() const { return category_name_id.value; }
+        };
 
-        using category_index = multi_index< "categoryinfo"_n, categoryinfo>;
+        // scope is category_name_id, only for token types with holder_count
+        TABLE holders {
+            name owner;
+            int64_t amount;
 
-        using stats_index = multi_index< "dgoodstats"_n, dgoodstats>;
+            uint64_t primary_key() const { return owner.value; }
+        };
 
-        using dgood_index = multi_index< "dgood"_n, dgood,
-            indexed_by< "byowner"_n, const_mem_fun< dgood, uint64_t, &dgood::get_owner> > >;
+        // scope is self, a token type tracked while it had supply, until addholders found every
+        // holder, held is the amount in its holders table
+        TABLE holderfill {
+            uint64_t category_name_id;
+            int64_t held;
 
-        using ask_index = multi_index< "asks"_n, asks,
-            indexed_by< "byseller"_n, const_mem_fun< asks, uint64_t, &asks::get_seller> > >;
+            uint64_t primary_key() const { return category_name_id; }
+        };
+
+        // scope is self
+        // burnnft or transfernft of dgood_ids, or of first_id..last_id when dgood_ids is empty,
+        // advanced by process
+        TABLE jobs {
+            uint64_t job_id;
+            name owner;
+            name type;
+            name to;
+            vector<uint64_t> dgood_ids;
+            uint64_t first_id;
+            uint64_t last_id;
+            // number of ids processed, for an id range the offset from first_id of the next id
+            uint64_t cursor;
 
-        using lock_index = multi_index< "lockednfts"_n, lockednfts>;
+            uint64_t primary_key() const { return job_id; }
+            uint64_t get_owner() const { return owner.value; }
+            uint64_t get_size() const { return dgood_ids.empty() ? last_id - first_id + 1 : dgood_ids.size(); }
+        };
+
+        // scope is self, progress of migrate
+        TABLE migration {
+            name     table;
+            uint64_t next_key;
+            // scope of next_key for tables with more than one
+            uint64_t next_scope;
+            // index of table in MIGRATION_STEPS, the number of steps once done
+            uint32_t step;
+        };
+
+        // scope is self, RAM billed for the rows migrate and migrateacct converted, one row per v1 table
+        TABLE migrated {
+            name     table;
+            uint64_t rows;
+            uint64_t v1_bytes;
+            uint64_t v2_bytes;
+
+            uint64_t primary_key() const { return table.value; }
+        };
+
+        using config_index = profiled< singleton< "tokenconfigs"_n, tokenconfigs > >;
+
+        using migration_index = profiled< singleton< "migration"_n, migration > >;
+
+        using migrated_index = profiled< multi_index< "migrated"_n, migrated > >;
+
+        using account_index = profiled< multi_index< "accounts"_n, accounts > >;
+
+        using balance_index = profiled< multi_index< "balances"_n, balances > >;
+
+        using holder_index = profiled< multi_index< "holders"_n, holders > >;
+
+        using holderfill_index = profiled< multi_index< "holderfill"_n, holderfill > >;
+
+        using type_index = profiled< multi_index< "tokentypes"_n, tokentypes > >;
+
+        using typestats_index = profiled< multi_index< "typestats"_n, typestats > >;
+
+        using category_index = profiled< multi_index< "categoryinfo"_n, categoryinfo> >;
+
+        using stats_index = profiled< multi_index< "dgoodstats"_n, dgoodstats> >;
+
+        using dgood_index = profiled< multi_index< "dgood"_n, dgood,
+            indexed_by< "byowner"_n, const_mem_fun< dgood, uint64_t, &dgood::get_owner> > > >;
+
+        using nft_index = profiled< multi_index< "nft"_n, nft,
+            indexed_by< "byownertype"_n, const_mem_fun< nft, uint128_t, &nft::get_owner_type> >,
+            indexed_by< "bytypeserial"_n, const_mem_fun< nft, uint128_t, &nft::get_type_serial> > > >;
+
+        using range_index = profiled< multi_index< "dgoodranges"_n, dgoodranges,
+            indexed_by< "byownertype"_n, const_mem_fun< dgoodranges, uint128_t, &dgoodranges::get_owner_type> >,
+            indexed_by< "bytypeserial"_n, const_mem_fun< dgoodranges, uint128_t, &dgoodranges::get_type_serial> > > >;
+
+        using uri_index = profiled< multi_index< "uris"_n, uris,
+            indexed_by< "byhash"_n, const_mem_fun< uris, uint64_t, &uris::get_hash> > > >;
+
+        using proceeds_index = profiled< multi_index< "proceeds"_n, proceeds > >;
+
+        using ask_index = profiled< multi_index< "asks"_n, asks,
+            indexed_by< "byseller"_n, const_mem_fun< asks, uint64_t, &asks::get_seller> >,
+            indexed_by< "byexpiry"_n, const_mem_fun< asks, uint64_t, &asks::get_expiration> >,
+            indexed_by< "bytypeprice"_n, const_mem_fun< asks, uint128_t, &asks::get_type_price> > > >;
+
+        using lock_index = profiled< multi_index< "lockednfts"_n, lockednfts> >;
+
+        using job_index = profiled< multi_index< "jobs"_n, jobs,
+            indexed_by< "byowner"_n, const_mem_fun< jobs, uint64_t, &jobs::get_owner> > > >;
 
       private:
-        map<name, asset> _calcfees(vector<uint64_t> dgood_ids, asset ask_amount, name seller);
-        void _changeowner( const name& from, const name& to, const vector<uint64_t>& dgood_ids, const string& memo, const bool& istransfer);
-        void _checkasset( const asset& amount, const bool& fungible );
-        void _mint(const name& to, const name& issuer, const name& category, const name& token_name,
-                  const asset& issued_supply, const string& relative_uri);
-        void _add_balance(const name& owner, const name& issuer, const name& category, const name& token_name,
-                         const uint64_t& category_name_id, const asset& quantity);
-        void _sub_balance(const name& owner, const uint64_t& category_name_id, const asset& quantity);
+        // tables opened by one action, multi_index keeps every row it has read so
+        // helpers sharing these instances read each config, stats or account row once
+        struct actionctx {
+            std::optional<tokenconfigs> config;
+            std::unique_ptr<nft_index> nft_table;
+            std::unique_ptr<type_index> type_table;
+            std::unique_ptr<typestats_index> typestats_table;
+            vector<std::unique_ptr<stats_index>> stats_tables;
+            vector<std::unique_ptr<balance_index>> balance_tables;
+            std::unique_ptr<uri_index> uri_table;
+            std::unique_ptr<holderfill_index> holderfill_table;
+            // RAM billed for the v1 rows converted and for the rows written in their place,
+            // reported by migrate and migrateacct
+            uint64_t v1_bytes = 0;
+            uint64_t v2_bytes = 0;
+        };
+
+        // amount a sale owes to one account
+        struct payout {
+            name account;
+            asset amount;
+        };
+
+        // tokens of one type within a batch of dgood_ids
+        struct typebatch {
+            uint64_t category_name_id;
+            asset quantity;
+        };
+
+        // tokens received by one account of a transfernfts
+        struct ownerbatch {
+            name owner;
+            vector<typebatch> batches;
+        };
+
+        tokenconfigs& _getconfig(actionctx& ctx);
+        void _saveconfig(actionctx& ctx);
+        nft_index& _nfttable(actionctx& ctx);
+        stats_index& _statstable(actionctx& ctx, const name& category);
+        const dgoodstats& _getstats(actionctx& ctx, const name& category, const name& token_name);
+        const tokentypes& _gettype(actionctx& ctx, const uint64_t& category_name_id);
+        const dgoodstats& _getstats(actionctx& ctx, const uint64_t& category_name_id);
+        typestats_index& _typestatstable(actionctx& ctx);
+        const typestats& _gettypestats(actionctx& ctx, const uint64_t& category_name_id);
+        typestats_index::const_iterator _addtypestats(actionctx& ctx, const dgoodstats& dgood_stats);
+        type_index& _typetable(actionctx& ctx);
+        void _addtype(actionctx& ctx, const uint64_t& category_name_id, const name& category, const name& token_name);
+        balance_index& _balancetable(actionctx& ctx, const name& owner);
+        balance_index::const_iterator _findbalance(actionctx& ctx, const name& owner, const uint64_t& category_name_id);
+
+        vector<payout> _calcfees(actionctx& ctx, const vector<uint64_t>& dgood_ids, const asset& ask_amount, const name& seller);
+        void _changeowner(actionctx& ctx, const name& from, const name& to, const vector<uint64_t>& dgood_ids, const bool& istransfer);
+        void _moveowner(actionctx& ctx, const name& from, const name& to, const vector<uint64_t>& dgood_ids,
+                        const bool& istransfer, vector<typebatch>& batches);
+        void _addpayout(vector<payout>& payouts, const name& account, const asset& amount);
+        void _sendeos(const name& account, const asset& amount);
+        void _addtobatch(vector<typebatch>& batches, const uint64_t& category_name_id, const asset& quantity);
+        void _addtoowner(vector<ownerbatch>& owners, const name& owner, const uint64_t& category_name_id, const asset& quantity);
+        void _checkasset(actionctx& ctx, const asset& amount, const bool& fungible );
+        bool _islocked(const nft& token);
+        void _unlock(nft_index& nft_table, const nft& token);
+        void _unlockask(actionctx& ctx, const asks& ask);
+        nft_index::const_iterator _findtoken(actionctx& ctx, const uint64_t& dgood_id, const uint64_t& batch_id);
+        uint64_t _asktype(actionctx& ctx, const vector<uint64_t>& dgood_ids, const uint64_t& batch_id);
+        nft_index::const_iterator _upgrade(actionctx& ctx, dgood_index& dgood_table, dgood_index::const_iterator dgood_itr,
+                                           const uint64_t& batch_id);
+        balance_index::const_iterator _upgrade(actionctx& ctx, account_index& account_table, account_index::const_iterator acct_itr);
+        void _addmigrated(const name& table, const uint64_t& rows, const uint64_t& v1_bytes, const uint64_t& v2_bytes);
+        uint64_t _nextid(actionctx& ctx);
+        nft _takefromrange(actionctx& ctx, const uint64_t& dgood_id, const name& ram_payer);
+        uint64_t _reserveids(actionctx& ctx, const uint64_t& count);
+        void _splitrange(actionctx& ctx, range_index& range_table, const uint64_t& dgood_id, const name& ram_payer);
+        template<typename VisitRange, typename VisitToken>
+        std::optional<uint64_t> _walktype(actionctx& ctx, const uint64_t& category_name_id, const uint64_t& from_serial,
+                                          const uint64_t& max_rows, const name& ram_payer,
+                                          VisitRange&& visit_range, VisitToken&& visit_token);
+        nft_index::const_iterator _materialize(actionctx& ctx, const uint64_t& dgood_id, const name& ram_payer);
+        uri_index& _uritable(actionctx& ctx);
+        uint64_t _intern(actionctx& ctx, const string& uri, const uint64_t& refs, const name& ram_payer);
+        void _adduri(actionctx& ctx, const uint64_t& uri_id, const int64_t& delta);
+        void _mint(actionctx& ctx, const name& to, const name& issuer, const uint64_t& category_name_id,
+                  const asset& issued_supply, const asset& quantity, const string& relative_uri);
+        void _add_balance(actionctx& ctx, const name& owner, const name& ram_payer, const uint64_t& category_name_id,
+                         const asset& quantity);
+        void _sub_balance(actionctx& ctx, const name& owner, const uint64_t& category_name_id, const asset& quantity);
+        void _setholder(actionctx& ctx, const name& owner, const name& ram_payer, const uint64_t& category_name_id,
+                        const int64_t& amount);
+        holderfill_index& _holderfilltable(actionctx& ctx);
+        string _geturi(actionctx& ctx, const uint64_t& uri_id);
+        ownedtoken _ownedtoken(actionctx& ctx, const name& category, const name& token_name, const uint64_t& id,
+                               const uint64_t& last_id, const uint64_t& serial_number, const bool& locked,
+                               const string& relative_uri);
 };
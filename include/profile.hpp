@@ -0,0 +1,143 @@
+#pragma once
+
+// Resource counters for profiling the contract on a local chain, built with -DDGOODS_PROFILE=ON.
+// Every table of the contract is declared as profiled< multi_index<...> >, which counts the db
+// calls made through it and the bytes of every row written. PROFILE_SCOPE() prints what the
+// enclosing function did, PROFILE_REPORT prints the totals of the action. Both only print to the
+// console, run nodeos with --contracts-console to see them. Without DGOODS_PROFILE profiled<T> is T
+// and the macros expand to nothing.
+
+#ifdef DGOODS_PROFILE
+
+#include <eosio/eosio.hpp>
+#include <eosio/datastream.hpp>
+#include <utility>
+
+namespace profile {
+
+    // db calls, inline actions and row bytes written
+    struct counters {
+        uint32_t finds = 0;
+        uint32_t gets = 0;
+        uint32_t modifies = 0;
+        uint32_t emplaces = 0;
+        uint32_t erases = 0;
+        uint32_t inline_actions = 0;
+        uint64_t bytes = 0;
+
+        counters operator-(const counters& c) const {
+            return { finds - c.finds, gets - c.gets, modifies - c.modifies, emplaces - c.emplaces,
+                     erases - c.erases, inline_actions - c.inline_actions, bytes - c.bytes };
+        }
+    };
+
+    // a contract instance runs a single action, so these are the counts of the current action
+    static counters totals;
+
+    template<typename L>
+    static inline void print_counters(const L& label, const counters& c) {
+        eosio::print( label, ": finds ", c.finds, " gets ", c.gets, " modifies ", c.modifies,
+                      " emplaces ", c.emplaces, " erases ", c.erases, " inline ", c.inline_actions,
+                      " bytes ", c.bytes, "\n" );
+    }
+
+    // counts of the enclosing function, nested calls included, printed when it returns
+    struct scope {
+        const char* label;
+        counters start;
+
+        scope(const char* l) : label( l ), start( totals ) {}
+        ~scope() { print_counters( label, totals - start ); }
+    };
+
+    // wraps the lambda of emplace or modify to add the serialized size of the row it wrote
+    template<typename L>
+    static inline auto sized(L& updater) {
+        return [&updater]( auto& row ) {
+            updater( row );
+            totals.bytes += eosio::pack_size( row );
+        };
+    }
+
+    // secondary index of a counted table
+    template<typename Index>
+    struct counted_index : Index {
+        counted_index(const Index& index) : Index( index ) {}
+
+        template<typename... A> auto find(A&&... a) const { totals.finds++; return Index::find( std::forward<A>( a )... ); }
+        template<typename... A> auto lower_bound(A&&... a) const { totals.finds++; return Index::lower_bound( std::forward<A>( a )... ); }
+        template<typename... A> auto upper_bound(A&&... a) const { totals.finds++; return Index::upper_bound( std::forward<A>( a )... ); }
+        template<typename... A> decltype(auto) get(A&&... a) const { totals.gets++; return Index::get( std::forward<A>( a )... ); }
+
+        template<typename I, typename L>
+        void modify(I&& itr, eosio::name payer, L&& updater) {
+            totals.modifies++;
+            Index::modify( std::forward<I>( itr ), payer, sized( updater ) );
+        }
+
+        template<typename I>
+        auto erase(I&& itr) {
+            totals.erases++;
+            return Index::erase( std::forward<I>( itr ) );
+        }
+    };
+
+    // multi_index or singleton counting the calls made through it
+    template<typename Table>
+    struct counted : Table {
+        using Table::Table;
+
+        template<typename... A> auto find(A&&... a) const { totals.finds++; return Table::find( std::forward<A>( a )... ); }
+        template<typename... A> auto require_find(A&&... a) const { totals.finds++; return Table::require_find( std::forward<A>( a )... ); }
+        template<typename... A> auto lower_bound(A&&... a) const { totals.finds++; return Table::lower_bound( std::forward<A>( a )... ); }
+        template<typename... A> auto upper_bound(A&&... a) const { totals.finds++; return Table::upper_bound( std::forward<A>( a )... ); }
+        template<typename... A> decltype(auto) get(A&&... a) { totals.gets++; return Table::get( std::forward<A>( a )... ); }
+        template<typename... A> decltype(auto) get(A&&... a) const { totals.gets++; return Table::get( std::forward<A>( a )... ); }
+
+        template<typename L>
+        auto emplace(eosio::name payer, L&& constructor) {
+            totals.emplaces++;
+            return Table::emplace( payer, sized( constructor ) );
+        }
+
+        template<typename I, typename L>
+        void modify(I&& target, eosio::name payer, L&& updater) {
+            totals.modifies++;
+            Table::modify( std::forward<I>( target ), payer, sized( updater ) );
+        }
+
+        template<typename I>
+        decltype(auto) erase(I&& target) {
+            totals.erases++;
+            return Table::erase( std::forward<I>( target ) );
+        }
+
+        // singleton
+        template<typename T>
+        void set(const T& value, eosio::name payer) {
+            totals.modifies++;
+            totals.bytes += eosio::pack_size( value );
+            Table::set( value, payer );
+        }
+
+        template<eosio::name::raw IndexName>
+        auto get_index() {
+            using index = decltype( Table::template get_index<IndexName>() );
+            return counted_index<index>( Table::template get_index<IndexName>() );
+        }
+    };
+}
+
+template<typename Table> using profiled = profile::counted<Table>;
+#define PROFILE_SCOPE() profile::scope profile_scope_( __func__ )
+#define PROFILE_ADD( counter, n ) profile::totals.counter += n
+#define PROFILE_REPORT( label ) profile::print_counters( label, profile::totals )
+
+#else
+
+template<typename Table> using profiled = Table;
+#define PROFILE_SCOPE()
+#define PROFILE_ADD( counter, n )
+#define PROFILE_REPORT( label )
+
+#endif
@@ -1,49 +1,73 @@
 #pragma once
 
 #include <string>
-#include <algorithm>
+#include <string_view>
 #include <cctype>
-#include <locale>
+#include <limits>
+#include <tuple>
 #include <eosio/eosio.hpp>
+#include <eosio/symbol.hpp>
 
 using namespace std;
 using namespace eosio;
 
 namespace utility {
 
-    // trim from left (in place)
-    static inline void ltrim(string& s) {
-        s.erase( s.begin(), find_if( s.begin(), s.end(), [](int ch) {
-            return !isspace(ch);
-        }));
+    // trim whitespace from both ends, views into s without copying
+    static inline string_view trim(string_view s) {
+        while ( !s.empty() && isspace( static_cast<unsigned char>( s.front() ) ) ) {
+            s.remove_prefix( 1 );
+        }
+        while ( !s.empty() && isspace( static_cast<unsigned char>( s.back() ) ) ) {
+            s.remove_suffix( 1 );
+        }
+        return s;
     }
 
-    // trim from right (in place)
-    static inline void rtrim(string& s) {
-        s.erase( find_if( s.rbegin(), s.rend(), [](int ch) {
-            return !isspace(ch);
-        }).base(), s.end());
+    // 10^exp computed at compile time
+    static constexpr int64_t ipow10(const uint8_t exp) {
+        return exp == 0 ? 1 : 10 * ipow10( exp - 1 );
     }
 
-    // trim from both ends (in place)
-    static inline string trim(string s) {
-        ltrim(s);
-        rtrim(s);
-        return s;
+    // fraction between 0 and 1 to basis points, rounded to the nearest
+    static inline uint16_t to_basis_points(const double& frac) {
+        return static_cast<uint16_t>( frac * 10000 + 0.5 );
     }
 
-    tuple<uint64_t, name> parsememo(const string& memo) {
+    // fails unless sym is the symbol of the token type, the message is only formatted on failure
+    static inline void check_symbol(const symbol& sym, const symbol& expected) {
+        if ( sym == expected ) {
+            return;
+        }
+        char msg[] = "precision of quantity must be ???";
+        char* p = msg + sizeof( "precision of quantity must be " ) - 1;
+        uint8_t precision = expected.precision();
+        if ( precision >= 100 ) *p++ = '0' + precision / 100;
+        if ( precision >= 10 ) *p++ = '0' + precision / 10 % 10;
+        *p++ = '0' + precision % 10;
+        *p = '\0';
+        check( false, msg );
+    }
+
+    // memo of a buynft transfer, "batch_id,to_account"
+    // parsed in place, malformed memos fail with a message instead of aborting in stoull
+    static inline tuple<uint64_t, name> parsememo(string_view memo) {
         auto comma_pos = memo.find(',');
-        string errormsg = "malformed memo: must have batch_id,to_account";
-        check ( comma_pos != string::npos, errormsg );
-        if ( comma_pos != string::npos ) {
-            check( ( comma_pos != memo.size() - 1 ), errormsg );
+        check( comma_pos != string_view::npos, "malformed memo: must have batch_id,to_account" );
+        string_view to_str = trim( memo.substr( comma_pos + 1 ) );
+        check( !to_str.empty(), "malformed memo: must have batch_id,to_account" );
+
+        string_view id_str = trim( memo.substr( 0, comma_pos ) );
+        check( !id_str.empty(), "malformed memo: batch_id must be a number" );
+        uint64_t batch_id = 0;
+        for ( char c: id_str ) {
+            check( c >= '0' && c <= '9', "malformed memo: batch_id must be a number" );
+            uint64_t digit = c - '0';
+            check( batch_id <= ( numeric_limits<uint64_t>::max() - digit ) / 10, "malformed memo: batch_id too large" );
+            batch_id = batch_id * 10 + digit;
         }
-        // will abort if stoull throws error since wasm no error checking
-        uint64_t batch_id = stoull( trim( memo.substr( 0, comma_pos ) ) );
-        name to_account = name( trim ( memo.substr( comma_pos + 1 ) ) );
+        name to_account = name( to_str );
 
         return make_tuple(batch_id, to_account);
-
     }
 }
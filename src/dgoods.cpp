@@ -1,5 +1,4 @@
 #include <dgoods.hpp>
-#include <math.h>
 
 ACTION dgoods::setconfig(const symbol_code& sym, const string& version) {
 
@@ -30,8 +29,8 @@ ACTION dgoods::create(const name& issuer,
 
     require_auth( get_self() );
 
-
-    _checkasset( max_supply, fungible );
+    actionctx ctx;
+    _checkasset( ctx, max_supply, fungible );
     // check if issuer account exists
     check( is_account( issuer ), "issuer account does not exist" );
     check( is_account( rev_partner), "rev_partner account does not exist" );
@@ -39,10 +38,10 @@ ACTION dgoods::create(const name& issuer,
     check( ( rev_split <= 1.0 ) && (rev_split >= 0.0), "rev_split must be between 0 and 1" );
 
     // get category_name_id
-    config_index config_table( get_self(), get_self().value );
-    check(config_table.exists(), "Symbol table does not exist, setconfig first");
-    auto config_singleton  = config_table.get();
+    auto& config_singleton = _getconfig( ctx );
     auto category_name_id = config_singleton.category_name_id;
+    // nft and balances rows store it as a varuint32
+    check( category_name_id <= numeric_limits<uint32_t>::max(), "no category_name_id left" );
 
 
     category_index category_table( get_self(), get_self().value );
@@ -63,7 +62,7 @@ ACTION dgoods::create(const name& issuer,
     auto existing_token = stats_table.find( token_name.value );
     check( existing_token == stats_table.end(), "Token with category and token_name exists" );
     // token type hasn't been created, create it
-    stats_table.emplace( get_self(), [&]( auto& stats ) {
+    auto stats_itr = stats_table.emplace( get_self(), [&]( auto& stats ) {
         stats.category_name_id = category_name_id;
         stats.issuer = issuer;
         stats.rev_partner= rev_partner;
@@ -75,13 +74,16 @@ ACTION dgoods::create(const name& issuer,
         stats.current_supply = current_supply;
         stats.issued_supply = issued_supply;
         stats.rev_split = rev_split;
+        stats.rev_split_bps.emplace( to_basis_points( rev_split ) );
         stats.base_uri = base_uri;
         stats.max_supply = max_supply;
     });
+    _addtypestats( ctx, *stats_itr );
+    _addtype( ctx, category_name_id, category, token_name );
 
     // successful creation of token, update category_name_id to reflect
     config_singleton.category_name_id++;
-    config_table.set( config_singleton, get_self() );
+    _saveconfig( ctx );
 }
 
 
@@ -96,31 +98,78 @@ ACTION dgoods::issue(const name& to,
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
     // dgoodstats table
-    stats_index stats_table( get_self(), category.value );
+    actionctx ctx;
+    auto& stats_table = _statstable( ctx, category );
     const auto& dgood_stats = stats_table.get( token_name.value,
                                                "Token with category and token_name does not exist" );
 
     // ensure have issuer authorization and valid quantity
     require_auth( dgood_stats.issuer );
 
-    _checkasset( quantity, dgood_stats.fungible );
-    string string_precision = "precision of quantity must be " + to_string( dgood_stats.max_supply.symbol.precision() );
-    check( quantity.symbol == dgood_stats.max_supply.symbol, string_precision.c_str() );
+    _checkasset( ctx, quantity, dgood_stats.fungible );
+    check_symbol( quantity.symbol, dgood_stats.max_supply.symbol );
     // check cannot issue more than max supply, careful of overflow of uint
     check( quantity.amount <= (dgood_stats.max_supply.amount - dgood_stats.current_supply.amount), "Cannot issue more than max supply" );
 
+    _addtype( ctx, dgood_stats.category_name_id, category, token_name );
     if (dgood_stats.fungible == false) {
         check( quantity.amount <= 100, "can issue up to 100 at a time");
-        asset issued_supply = dgood_stats.issued_supply;
-        asset one_token = asset( 1, dgood_stats.max_supply.symbol);
-        for ( uint64_t i = 1; i <= quantity.amount; i++ ) {
-            _mint(to, dgood_stats.issuer, category, token_name,
-                  issued_supply, relative_uri);
-            // used to keep track of serial number when minting multiple
-            issued_supply += one_token;
-        }
+        check( quantity.amount <= int64_t( MAX_TOKEN_NUMBER ) - dgood_stats.issued_supply.amount, "no serial_number left" );
+        _mint(ctx, to, dgood_stats.issuer, dgood_stats.category_name_id,
+              dgood_stats.issued_supply, quantity, relative_uri);
     }
-    _add_balance(to, get_self(), category, token_name, dgood_stats.category_name_id, quantity);
+    _add_balance(ctx, to, get_self(), dgood_stats.category_name_id, quantity);
+
+    // increase current supply
+    stats_table.modify( dgood_stats, same_payer, [&]( auto& s ) {
+        s.current_supply += quantity;
+        s.issued_supply += quantity;
+    });
+}
+
+ACTION dgoods::issuerange(const name& to,
+                          const name& category,
+                          const name& token_name,
+                          const asset& quantity,
+                          const string& relative_uri,
+                          const string& memo) {
+
+    check( is_account( to ), "to account does not exist");
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+    // dgoodstats table
+    actionctx ctx;
+    auto& stats_table = _statstable( ctx, category );
+    const auto& dgood_stats = stats_table.get( token_name.value,
+                                               "Token with category and token_name does not exist" );
+
+    // ensure have issuer authorization and valid quantity
+    require_auth( dgood_stats.issuer );
+
+    check( dgood_stats.fungible == false, "Cannot call issuerange on fungible token, call issue instead" );
+    _checkasset( ctx, quantity, dgood_stats.fungible );
+    check_symbol( quantity.symbol, dgood_stats.max_supply.symbol );
+    // check cannot issue more than max supply, careful of overflow of uint
+    check( quantity.amount <= (dgood_stats.max_supply.amount - dgood_stats.current_supply.amount), "Cannot issue more than max supply" );
+    check( quantity.amount <= int64_t( MAX_TOKEN_NUMBER ) - dgood_stats.issued_supply.amount, "no serial_number left" );
+
+    _addtype( ctx, dgood_stats.category_name_id, category, token_name );
+    // reserve the ids as a single row, nft rows are only written once a token is first used
+    uint64_t first_id = _reserveids( ctx, quantity.amount );
+    uint64_t last_id = first_id + quantity.amount - 1;
+    uint64_t uri_id = _intern( ctx, relative_uri, 1, dgood_stats.issuer );
+    range_index range_table( get_self(), get_self().value );
+    range_table.emplace( dgood_stats.issuer, [&]( auto& r ) {
+        r.last_id = last_id;
+        r.first_id = first_id;
+        r.serial_number = dgood_stats.issued_supply.amount + 1;
+        r.owner = to;
+        r.category_name_id = dgood_stats.category_name_id;
+        r.uri_id = uri_id;
+    });
+    SEND_INLINE_ACTION( *this, logcall, { { get_self(), "active"_n } }, { first_id, last_id } );
+    PROFILE_ADD( inline_actions, 1 );
+    _add_balance(ctx, to, get_self(), dgood_stats.category_name_id, quantity);
 
     // increase current supply
     stats_table.modify( dgood_stats, same_payer, [&]( auto& s ) {
@@ -135,32 +184,42 @@ ACTION dgoods::burnnft(const name& owner,
 
     check( dgood_ids.size() <= 20, "max batch size of 20" );
     // loop through vector of dgood_ids, check token exists
-    lock_index lock_table( get_self(), get_self().value );
-    dgood_index dgood_table( get_self(), get_self().value );
+    actionctx ctx;
+    auto& nft_table = _nfttable( ctx );
+    // supply and balance are lowered once per token type, not once per token
+    vector<typebatch> batches;
     for ( auto const& dgood_id: dgood_ids ) {
-        const auto& token = dgood_table.get( dgood_id, "token does not exist" );
+        auto token_itr = _findtoken( ctx, dgood_id, UNLOCKED );
+        // tokens never used since issuerange are cut out of their range instead
+        const nft token = token_itr != nft_table.end() ? *token_itr : _takefromrange( ctx, dgood_id, owner );
         check( token.owner == owner, "must be token owner" );
 
-        stats_index stats_table( get_self(), token.category.value );
-        const auto& dgood_stats = stats_table.get( token.token_name.value, "dgood stats not found" );
+        const auto& type_stats = _gettypestats( ctx, token.category_name_id.value );
 
-        check( dgood_stats.burnable == true, "Not burnable");
-        check( dgood_stats.fungible == false, "Cannot call burnnft on fungible token, call burnft instead");
+        check( type_stats.burnable == true, "Not burnable");
+        check( type_stats.fungible == false, "Cannot call burnnft on fungible token, call burnft instead");
         // make sure token not locked;
-        auto locked_nft = lock_table.find( dgood_id );
-        check(locked_nft == lock_table.end(), "token locked");
+        check( !_islocked( token ), "token locked");
+
+        // erase token
+        if ( token_itr != nft_table.end() ) {
+            nft_table.erase( token_itr );
+        }
+        _adduri( ctx, token.uri_id.value, -1 );
+        // amount 1, precision 0 for NFT
+        _addtobatch( batches, type_stats.category_name_id, asset( 1, type_stats.supply_symbol ) );
+    }
 
-        asset quantity(1, dgood_stats.max_supply.symbol);
+    for ( auto const& batch: batches ) {
         // decrease current supply
-        stats_table.modify( dgood_stats, same_payer, [&]( auto& s ) {
-            s.current_supply -= quantity;
+        const auto& type = _gettype( ctx, batch.category_name_id );
+        const auto& dgood_stats = _getstats( ctx, type.category, type.token_name );
+        _statstable( ctx, type.category ).modify( dgood_stats, same_payer, [&]( auto& s ) {
+            s.current_supply -= batch.quantity;
         });
 
         // lower balance from owner
-        _sub_balance(owner, dgood_stats.category_name_id, quantity);
-
-        // erase token
-        dgood_table.erase( token );
+        _sub_balance(ctx, owner, batch.category_name_id, batch.quantity);
     }
 }
 
@@ -169,18 +228,18 @@ ACTION dgoods::burnft(const name& owner,
                       const asset& quantity) {
     require_auth(owner);
 
+    actionctx ctx;
+    check( _findbalance( ctx, owner, category_name_id ) != _balancetable( ctx, owner ).end(),
+           "token does not exist in account" );
 
-    account_index from_account( get_self(), owner.value );
-    const auto& acct = from_account.get( category_name_id, "token does not exist in account" );
+    const auto& type = _gettype( ctx, category_name_id );
+    auto& stats_table = _statstable( ctx, type.category );
+    const auto& dgood_stats = stats_table.get( type.token_name.value, "dgood stats not found" );
 
-    stats_index stats_table( get_self(), acct.category.value );
-    const auto& dgood_stats = stats_table.get( acct.token_name.value, "dgood stats not found" );
-
-    _checkasset( quantity, true );
-    string string_precision = "precision of quantity must be " + to_string( dgood_stats.max_supply.symbol.precision() );
-    check( quantity.symbol == dgood_stats.max_supply.symbol, string_precision.c_str() );
+    _checkasset( ctx, quantity, true );
+    check_symbol( quantity.symbol, dgood_stats.max_supply.symbol );
     // lower balance from owner
-    _sub_balance(owner, category_name_id, quantity);
+    _sub_balance(ctx, owner, category_name_id, quantity);
 
     // decrease current supply
     stats_table.modify( dgood_stats, same_payer, [&]( auto& s ) {
@@ -204,7 +263,196 @@ ACTION dgoods::transfernft(const name& from,
     // check memo size
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
-    _changeowner( from, to, dgood_ids, memo, true );
+    actionctx ctx;
+    _changeowner( ctx, from, to, dgood_ids, true );
+}
+
+ACTION dgoods::transfernfts(const name& from,
+                            const vector<nftrecipient>& recipients,
+                            const string& memo ) {
+    // ensure authorized to send from account
+    require_auth( from );
+    check( !recipients.empty(), "no recipients" );
+
+    // check memo size
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+    size_t token_count = 0;
+    for ( auto const& recipient: recipients ) {
+        token_count += recipient.dgood_ids.size();
+    }
+    check( token_count <= 100, "max batch size of 100" );
+
+    // every token is checked in one pass sharing the stats rows, balances are written once per
+    // recipient and token type and once per token type for the sender
+    actionctx ctx;
+    vector<ownerbatch> owners;
+    for ( auto const& recipient: recipients ) {
+        check( recipient.to != from, "cannot transfer to self" );
+        size_t i = 0;
+        while ( i < owners.size() && owners[i].owner != recipient.to ) {
+            i++;
+        }
+        if ( i == owners.size() ) {
+            check( is_account( recipient.to ), "to account does not exist");
+            owners.push_back( { recipient.to, {} } );
+        }
+        _moveowner( ctx, from, recipient.to, recipient.dgood_ids, true, owners[i].batches );
+    }
+
+    require_recipient( from );
+    vector<typebatch> sent;
+    for ( auto const& owner: owners ) {
+        require_recipient( owner.owner );
+        for ( auto const& batch: owner.batches ) {
+            _add_balance(ctx, owner.owner, get_self(), batch.category_name_id, batch.quantity);
+            _addtobatch( sent, batch.category_name_id, batch.quantity );
+        }
+    }
+    for ( auto const& batch: sent ) {
+        _sub_balance(ctx, from, batch.category_name_id, batch.quantity);
+    }
+}
+
+// burns every token of a type from from_serial on, whoever holds it, in chunks of max_rows
+std::optional<uint64_t> dgoods::burntype(const name& category,
+                                         const name& token_name,
+                                         const uint64_t& from_serial,
+                                         const uint64_t& max_rows) {
+    actionctx ctx;
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
+    require_auth( dgood_stats.issuer );
+    check( dgood_stats.burnable == true, "Not burnable");
+    check( dgood_stats.fungible == false, "Cannot call burntype on fungible token, call burnft instead");
+
+    uint64_t category_name_id = dgood_stats.category_name_id;
+    // balances are lowered once per holder
+    vector<ownerbatch> owners;
+    auto next_serial = _walktype( ctx, category_name_id, from_serial, max_rows, dgood_stats.issuer,
+        [&]( auto& ranges, auto range ) {
+            // a range is burned whole
+            _addtoowner( owners, range->owner, category_name_id,
+                         asset( range->last_id - range->first_id + 1, dgood_stats.max_supply.symbol ) );
+            _adduri( ctx, range->uri_id.value, -1 );
+            return ranges.erase( range );
+        },
+        [&]( auto& tokens, auto token ) {
+            // listed tokens stay until their ask is closed
+            if ( _islocked( *token ) ) {
+                return ++token;
+            }
+            // amount 1, precision 0 for NFT
+            _addtoowner( owners, token->owner, category_name_id, asset( 1, dgood_stats.max_supply.symbol ) );
+            _adduri( ctx, token->uri_id.value, -1 );
+            return tokens.erase( token );
+        });
+
+    asset burned( 0, dgood_stats.max_supply.symbol );
+    for ( auto const& owner: owners ) {
+        for ( auto const& batch: owner.batches ) {
+            _sub_balance(ctx, owner.owner, batch.category_name_id, batch.quantity);
+            burned += batch.quantity;
+        }
+    }
+    if ( burned.amount > 0 ) {
+        // decrease current supply
+        _statstable( ctx, category ).modify( dgood_stats, same_payer, [&]( auto& s ) {
+            s.current_supply -= burned;
+        });
+    }
+    return next_serial;
+}
+
+// sets relative_uri of every token of a type from from_serial on, in chunks of max_rows
+std::optional<uint64_t> dgoods::seturis(const name& category,
+                                        const name& token_name,
+                                        const string& relative_uri,
+                                        const uint64_t& from_serial,
+                                        const uint64_t& max_rows) {
+    actionctx ctx;
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
+    require_auth( dgood_stats.issuer );
+    check( dgood_stats.fungible == false, "Cannot call seturis on fungible token");
+
+    uint64_t uri_id = _intern( ctx, relative_uri, 0, dgood_stats.issuer );
+    // references moved to uri_id
+    int64_t refs = 0;
+    // rows may grow and their payer hasn't authorized this, the issuer pays for the rewritten rows
+    auto next_serial = _walktype( ctx, dgood_stats.category_name_id, from_serial, max_rows, dgood_stats.issuer,
+        [&]( auto& ranges, auto range ) {
+            if ( range->uri_id.value != uri_id ) {
+                _adduri( ctx, range->uri_id.value, -1 );
+                ranges.modify( range, dgood_stats.issuer, [&]( auto& r ) {
+                    r.uri_id = uri_id;
+                });
+                refs++;
+            }
+            return ++range;
+        },
+        [&]( auto& tokens, auto token ) {
+            if ( token->uri_id.value != uri_id ) {
+                _adduri( ctx, token->uri_id.value, -1 );
+                tokens.modify( token, dgood_stats.issuer, [&]( auto& t ) {
+                    t.uri_id = uri_id;
+                });
+                refs++;
+            }
+            return ++token;
+        });
+    // also frees uri_id if no row took it
+    _adduri( ctx, uri_id, refs );
+    return next_serial;
+}
+
+ACTION dgoods::trackholders(const name& category,
+                            const name& token_name) {
+    actionctx ctx;
+    auto& stats_table = _statstable( ctx, category );
+    const auto& dgood_stats = stats_table.get( token_name.value, "dgood stats not found" );
+    require_auth( dgood_stats.issuer );
+    check( !dgood_stats.holder_count.has_value(), "holders already tracked" );
+
+    stats_table.modify( dgood_stats, same_payer, [&]( auto& s ) {
+        // extensions are serialized in order, holder_count needs rev_split_bps
+        if ( !s.rev_split_bps.has_value() ) {
+            s.rev_split_bps.emplace( to_basis_points( s.rev_split ) );
+        }
+        s.holder_count.emplace( 0 );
+    });
+    auto& typestats_table = _typestatstable( ctx );
+    typestats_table.modify( _gettypestats( ctx, dgood_stats.category_name_id ), same_payer, [&]( auto& t ) {
+        t.holders_tracked = true;
+    });
+    // balances are scoped by owner, holders from before tracking started are added by addholders
+    if ( dgood_stats.current_supply.amount > 0 ) {
+        _holderfilltable( ctx ).emplace( dgood_stats.issuer, [&]( auto& f ) {
+            f.category_name_id = dgood_stats.category_name_id;
+            f.held = 0;
+        });
+    }
+}
+
+// adds the holders of a type from before trackholders, scopes can't be listed on chain so owners are
+// passed in, done once the holders hold the whole supply
+ACTION dgoods::addholders(const name& category,
+                          const name& token_name,
+                          const vector<name>& owners) {
+    actionctx ctx;
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
+    require_auth( dgood_stats.issuer );
+
+    auto& fill_table = _holderfilltable( ctx );
+    const auto& fill = fill_table.get( dgood_stats.category_name_id, "holders already complete" );
+    for ( auto const& owner: owners ) {
+        auto& balance_table = _balancetable( ctx, owner );
+        auto balance = _findbalance( ctx, owner, dgood_stats.category_name_id );
+        if ( balance != balance_table.end() ) {
+            _setholder( ctx, owner, dgood_stats.issuer, dgood_stats.category_name_id, balance->amount );
+        }
+    }
+    if ( fill.held == dgood_stats.current_supply.amount ) {
+        fill_table.erase( fill );
+    }
 }
 
 ACTION dgoods::transferft(const name& from,
@@ -227,16 +475,55 @@ ACTION dgoods::transferft(const name& from,
     require_recipient( from );
     require_recipient( to );
 
-    stats_index stats_table( get_self(), category.value );
-    const auto& dgood_stats = stats_table.get( token_name.value, "dgood stats not found" );
+    actionctx ctx;
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
     check( dgood_stats.transferable == true, "not transferable");
     check( dgood_stats.fungible == true, "Must be fungible token");
 
-    _checkasset( quantity, true );
-    string string_precision = "precision of quantity must be " + to_string( dgood_stats.max_supply.symbol.precision() );
-    check( quantity.symbol == dgood_stats.max_supply.symbol, string_precision.c_str() );
-    _sub_balance(from, dgood_stats.category_name_id, quantity);
-    _add_balance(to, get_self(), category, token_name, dgood_stats.category_name_id, quantity);
+    _checkasset( ctx, quantity, true );
+    check_symbol( quantity.symbol, dgood_stats.max_supply.symbol );
+    _sub_balance(ctx, from, dgood_stats.category_name_id, quantity);
+    _add_balance(ctx, to, get_self(), dgood_stats.category_name_id, quantity);
+}
+
+ACTION dgoods::airdropft(const name& from,
+                         const name& category,
+                         const name& token_name,
+                         const vector<ftrecipient>& recipients,
+                         const string& memo ) {
+    // ensure authorized to send from account
+    require_auth( from );
+    check( !recipients.empty(), "no recipients" );
+
+    // check memo size
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+    // token type is validated once for all recipients
+    actionctx ctx;
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
+    check( dgood_stats.transferable == true, "not transferable");
+    check( dgood_stats.fungible == true, "Must be fungible token");
+
+    // max_supply was checked against the config symbol by create, matching it is enough
+    asset total( 0, dgood_stats.max_supply.symbol );
+    for ( auto const& recipient: recipients ) {
+        check( recipient.to != from, "cannot transfer to self" );
+        check_symbol( recipient.quantity.symbol, total.symbol );
+        check( recipient.quantity.amount > 0, "amount must be positive" );
+        // asset addition checks for overflow
+        total += recipient.quantity;
+    }
+
+    // sender is debited once by the total
+    require_recipient( from );
+    _sub_balance(ctx, from, dgood_stats.category_name_id, total);
+
+    // ctx keeps the typestats row read once for every recipient
+    for ( auto const& recipient: recipients ) {
+        check( is_account( recipient.to ), "to account does not exist");
+        require_recipient( recipient.to );
+        _add_balance(ctx, recipient.to, get_self(), dgood_stats.category_name_id, recipient.quantity);
+    }
 }
 
 ACTION dgoods::listsalenft(const name& seller,
@@ -245,30 +532,34 @@ ACTION dgoods::listsalenft(const name& seller,
     require_auth( seller );
 
     check (dgood_ids.size() <= 20, "max batch size of 20");
-    check( net_sale_amount.amount > .02 * pow(10, net_sale_amount.symbol.precision()), "minimum price of at least 0.02 EOS");
-    check( net_sale_amount.symbol == symbol( symbol_code("EOS"), 4), "only accept EOS for sale" );
+    check( !dgood_ids.empty(), "no dgood_ids to list" );
+    check( net_sale_amount.symbol == symbol( symbol_code("EOS"), EOS_PRECISION ), "only accept EOS for sale" );
+    check( net_sale_amount.amount > MIN_ASK_AMOUNT, "minimum price of at least 0.02 EOS");
 
-    dgood_index dgood_table( get_self(), get_self().value );
+    actionctx ctx;
+    auto& nft_table = _nfttable( ctx );
     for ( auto const& dgood_id: dgood_ids ) {
-        const auto& token = dgood_table.get( dgood_id, "token does not exist" );
+        auto token_itr = _findtoken( ctx, dgood_id, UNLOCKED );
+        if ( token_itr == nft_table.end() ) {
+            token_itr = _materialize( ctx, dgood_id, seller );
+        }
+        const auto& token = *token_itr;
 
-        stats_index stats_table( get_self(), token.category.value );
-        const auto& dgood_stats = stats_table.get( token.token_name.value, "dgood stats not found" );
+        const auto& type_stats = _gettypestats( ctx, token.category_name_id.value );
 
-        check( dgood_stats.sellable == true, "not sellable");
+        check( type_stats.sellable == true, "not sellable");
         check ( seller == token.owner, "not token owner");
 
         // make sure token not locked;
-        lock_index lock_table( get_self(), get_self().value );
-        auto locked_nft = lock_table.find( dgood_id );
-        check(locked_nft == lock_table.end(), "token locked");
+        check( !_islocked( token ), "token locked");
 
-        // add token to lock table
-        lock_table.emplace( seller, [&]( auto& l ) {
-            l.dgood_id = dgood_id;
+        // lock token to this ask
+        nft_table.modify( token, same_payer, [&]( auto& t ) {
+            t.lock = 1;
         });
     }
 
+    uint64_t category_name_id = _asktype( ctx, dgood_ids, dgood_ids[0] );
     ask_index ask_table( get_self(), get_self().value );
     // add batch to table of asks
     // set id to the first dgood being listed, if only one being listed, simplifies life
@@ -278,6 +569,7 @@ ACTION dgoods::listsalenft(const name& seller,
         a.seller = seller;
         a.amount = net_sale_amount;
         a.expiration = time_point_sec(current_time_point()) + WEEK_SEC;
+        a.category_name_id.emplace( category_name_id );
     });
 }
 
@@ -286,29 +578,228 @@ ACTION dgoods::closesalenft(const name& seller,
     ask_index ask_table( get_self(), get_self().value );
     const auto& ask = ask_table.get( batch_id, "cannot find sale to close" );
 
-    lock_index lock_table( get_self(), get_self().value );
     if ( time_point_sec(current_time_point()) <= ask.expiration ) {
         require_auth( seller );
         check( ask.seller == seller, "only the seller can cancel a sale in progress");
     }
     // sale has expired anyone can call this and ask removed, token removed from asks/lock
-    for ( auto const& dgood_id: ask.dgood_ids ) {
-        const auto& locked_nft = lock_table.get( dgood_id, "dgood not found in lock table" );
-        lock_table.erase( locked_nft );
-    }
+    actionctx ctx;
+    _unlockask( ctx, ask );
     ask_table.erase( ask );
 }
 
+// closes expired asks oldest first, anyone can call this like closesalenft on an expired ask
+ACTION dgoods::sweepexpired(const uint64_t& max_rows) {
+    ask_index ask_table( get_self(), get_self().value );
+    auto expiry_index = ask_table.get_index<"byexpiry"_n>();
+    auto now = time_point_sec(current_time_point());
+
+    actionctx ctx;
+    uint64_t rows = 0;
+    auto ask = expiry_index.begin();
+    for ( ; ask != expiry_index.end() && ask->expiration < now && rows < max_rows; rows++ ) {
+        _unlockask( ctx, *ask );
+        ask = expiry_index.erase( ask );
+    }
+}
+
+// burns or transfers more tokens than fit in one transaction, process carries it out
+ACTION dgoods::queuejob(const name& owner,
+                        const name& type,
+                        const name& to,
+                        const vector<uint64_t>& dgood_ids,
+                        const uint64_t& first_id,
+                        const uint64_t& last_id) {
+    require_auth( owner );
+
+    check( type == "burnnft"_n || type == "transfernft"_n, "type must be burnnft or transfernft" );
+    if ( type == "transfernft"_n ) {
+        check( owner != to, "cannot transfer to self" );
+        check( is_account( to ), "to account does not exist");
+    }
+    if ( dgood_ids.empty() ) {
+        check( first_id <= last_id && last_id < numeric_limits<uint64_t>::max(), "invalid id range" );
+    } else {
+        check( first_id == 0 && last_id == 0, "give dgood_ids or an id range, not both" );
+    }
+
+    range_index range_table( get_self(), get_self().value );
+    if ( dgood_ids.empty() ) {
+        // ranges of the owner crossing the job's bounds are split here once, billed to the owner, so
+        // process moves whole ranges and writes no row
+        actionctx ctx;
+        for ( uint64_t bound: { first_id, last_id + 1 } ) {
+            auto range = range_table.lower_bound( bound );
+            if ( range != range_table.end() && range->owner == owner ) {
+                _splitrange( ctx, range_table, bound, owner );
+            }
+        }
+    } else {
+        // process would have to cut the token out of its range and nobody it could bill signs it
+        for ( auto const& dgood_id: dgood_ids ) {
+            auto range = range_table.lower_bound( dgood_id );
+            check( range == range_table.end() || range->first_id > dgood_id,
+                   "dgood_id is in a range, queue an id range instead" );
+        }
+    }
+
+    job_index job_table( get_self(), get_self().value );
+    job_table.emplace( owner, [&]( auto& j ) {
+        j.job_id = job_table.available_primary_key();
+        j.owner = owner;
+        j.type = type;
+        j.to = type == "transfernft"_n ? to : name();
+        j.dgood_ids = dgood_ids;
+        j.first_id = first_id;
+        j.last_id = last_id;
+        j.cursor = 0;
+    });
+}
+
+// advances a job by at most max_steps rows, anyone can call this
+ACTION dgoods::process(const uint64_t& job_id,
+                       const uint64_t& max_steps) {
+    job_index job_table( get_self(), get_self().value );
+    const auto& job = job_table.get( job_id, "job does not exist" );
+    bool isburn = job.type == "burnnft"_n;
+
+    actionctx ctx;
+    auto& nft_table = _nfttable( ctx );
+    range_index range_table( get_self(), get_self().value );
+    dgood_index dgood_table( get_self(), get_self().value );
+    lock_index lock_table( get_self(), get_self().value );
+    // supply and balances change once per token type at the end
+    vector<typebatch> batches;
+    uint64_t cursor = job.cursor;
+    uint64_t job_size = job.get_size();
+    for ( uint64_t steps = 0; steps < max_steps && cursor < job_size; steps++ ) {
+        uint64_t dgood_id;
+        if ( job.dgood_ids.empty() ) {
+            // a step is the next token or range of the job, ids without a row are passed over
+            dgood_id = job.first_id + cursor;
+            uint64_t next_id = job.last_id + 1;
+            auto token_itr = nft_table.lower_bound( dgood_id );
+            if ( token_itr != nft_table.end() ) {
+                next_id = std::min( next_id, token_itr->id );
+            }
+            auto dgood_itr = dgood_table.lower_bound( dgood_id );
+            if ( dgood_itr != dgood_table.end() ) {
+                next_id = std::min( next_id, dgood_itr->id );
+            }
+            auto range = range_table.lower_bound( dgood_id );
+            if ( range != range_table.end() ) {
+                next_id = std::min( next_id, std::max( range->first_id, dgood_id ) );
+            }
+            if ( next_id > job.last_id ) {
+                cursor = job_size;
+                break;
+            }
+            dgood_id = next_id;
+            if ( range != range_table.end() && range->first_id <= dgood_id ) {
+                cursor = std::min( range->last_id, job.last_id ) + 1 - job.first_id;
+                // queuejob split the owner's ranges at the job's bounds, one crossing them was not
+                // the owner's when the job was queued
+                if ( range->owner != job.owner || range->first_id < job.first_id || range->last_id > job.last_id ) {
+                    continue;
+                }
+                uint64_t category_name_id = range->category_name_id.value;
+                const auto& type_stats = _gettypestats( ctx, category_name_id );
+                if ( !( isburn ? type_stats.burnable : type_stats.transferable ) ) {
+                    continue;
+                }
+                // the range is burned or moved whole, its row is not materialized
+                _addtobatch( batches, category_name_id, asset( range->last_id - range->first_id + 1, type_stats.supply_symbol ) );
+                if ( isburn ) {
+                    _adduri( ctx, range->uri_id.value, -1 );
+                    range_table.erase( range );
+                } else {
+                    range_table.modify( range, same_payer, [&]( auto& r ) {
+                        r.owner = job.to;
+                    });
+                }
+                continue;
+            }
+            cursor = dgood_id - job.first_id + 1;
+        } else {
+            // queuejob took no id in a range, and ranges only shrink
+            dgood_id = job.dgood_ids[cursor++];
+        }
+
+        // ids that don't exist, changed owner or can't be moved since the job was queued are skipped
+        auto token_itr = nft_table.find( dgood_id );
+        if ( token_itr == nft_table.end() ) {
+            auto dgood_itr = dgood_table.find( dgood_id );
+            // a v1 lock only converts for the ask holding it, the token is locked either way
+            if ( dgood_itr == dgood_table.end() || lock_table.find( dgood_id ) != lock_table.end() ) {
+                continue;
+            }
+            token_itr = _upgrade( ctx, dgood_table, dgood_itr, UNLOCKED );
+        }
+        uint64_t category_name_id = token_itr->category_name_id.value;
+        const auto& type_stats = _gettypestats( ctx, category_name_id );
+        if ( token_itr->owner != job.owner || _islocked( *token_itr ) ||
+             !( isburn ? type_stats.burnable : type_stats.transferable ) ) {
+            continue;
+        }
+
+        if ( isburn ) {
+            _adduri( ctx, token_itr->uri_id.value, -1 );
+            nft_table.erase( token_itr );
+        } else {
+            nft_table.modify( token_itr, same_payer, [&]( auto& t ) {
+                t.owner = job.to;
+            });
+        }
+        // amount 1, precision 0 for NFT
+        _addtobatch( batches, category_name_id, asset( 1, type_stats.supply_symbol ) );
+    }
+
+    if ( !batches.empty() && !isburn ) {
+        require_recipient( job.owner );
+        require_recipient( job.to );
+    }
+    for ( auto const& batch: batches ) {
+        _sub_balance(ctx, job.owner, batch.category_name_id, batch.quantity);
+        if ( isburn ) {
+            const auto& type = _gettype( ctx, batch.category_name_id );
+            const auto& dgood_stats = _getstats( ctx, type.category, type.token_name );
+            _statstable( ctx, type.category ).modify( dgood_stats, same_payer, [&]( auto& s ) {
+                s.current_supply -= batch.quantity;
+            });
+        } else {
+            _add_balance(ctx, job.to, get_self(), batch.category_name_id, batch.quantity);
+        }
+    }
+
+    if ( cursor == job_size ) {
+        job_table.erase( job );
+    } else {
+        job_table.modify( job, same_payer, [&]( auto& j ) {
+            j.cursor = cursor;
+        });
+    }
+}
+
+ACTION dgoods::canceljob(const name& owner,
+                         const uint64_t& job_id) {
+    require_auth( owner );
+
+    job_index job_table( get_self(), get_self().value );
+    const auto& job = job_table.get( job_id, "job does not exist" );
+    check( job.owner == owner, "only the owner can cancel a job" );
+    job_table.erase( job );
+}
+
 void dgoods::buynft(const name& from,
                     const name& to,
                     const asset& quantity,
                     const string& memo) {
+    // don't allow spoofs, also skips the notification of every transfer the contract sends
+    if ( to != get_self() ) return;
     // allow EOS to be sent by sending with empty string memo
     if ( memo == "deposit" ) return;
-    // don't allow spoofs
-    if ( to != get_self() ) return;
     if ( from == name("eosio.stake") ) return;
-    check( quantity.symbol == symbol( symbol_code("EOS"), 4), "Buy only with EOS" );
+    check( quantity.symbol == symbol( symbol_code("EOS"), EOS_PRECISION ), "Buy only with EOS" );
     check( memo.length() <= 32, "memo too long" );
 
     //memo format comma separated
@@ -323,107 +814,622 @@ void dgoods::buynft(const name& from,
     check (ask.expiration > time_point_sec(current_time_point()), "sale has expired");
 
     // nft(s) bought, change owner to buyer regardless of transferable
-    _changeowner( ask.seller, to_account, ask.dgood_ids, "bought by: " + to_account.to_string(), false);
+    actionctx ctx;
+    _changeowner( ctx, ask.seller, to_account, ask.dgood_ids, false );
 
     // amounts owed to all parties
-    map<name, asset> fee_map = _calcfees(ask.dgood_ids, ask.amount, ask.seller);
-    for(auto const& fee : fee_map) {
-        auto account = fee.first;
-        auto amount = fee.second;
-
-        // if seller is contract, no need to send EOS again
-        if ( account != get_self() ) {
+    vector<payout> payouts = _calcfees(ctx, ask.dgood_ids, ask.amount, ask.seller);
+    const auto& config_singleton = _getconfig( ctx );
+    bool accrue = config_singleton.accrue_proceeds.has_value() && config_singleton.accrue_proceeds.value();
+    proceeds_index proceeds_table( get_self(), get_self().value );
+    for(auto const& fee : payouts) {
+        auto account = fee.account;
+        auto amount = fee.amount;
+
+        // if seller is contract, no need to send EOS again, a rev_split of 0 or 1 leaves nothing
+        // to the partner or seller
+        if ( account == get_self() || amount.amount <= 0 ) {
+            continue;
+        }
+        if ( accrue ) {
+            // credited now, paid out in bulk by withdraw or settle
+            auto owed = proceeds_table.find( account.value );
+            if ( owed == proceeds_table.end() ) {
+                proceeds_table.emplace( get_self(), [&]( auto& p ) {
+                    p.account = account;
+                    p.amount = amount;
+                });
+            } else {
+                proceeds_table.modify( owed, same_payer, [&]( auto& p ) {
+                    p.amount += amount;
+                });
+            }
+        } else {
             // send EOS to account owed
-            action( permission_level{ get_self(), name("active") },
-                    name("eosio.token"), name("transfer"),
-                    make_tuple( get_self(), account, amount, string("sale of dgood") ) ).send();
+            _sendeos( account, amount );
         }
     }
 
-    // remove locks, remove from ask table
-    lock_index lock_table( get_self(), get_self().value );
+    // _changeowner released the locks, remove sale listing
+    ask_table.erase( ask );
+}
 
-    for ( auto const& dgood_id: ask.dgood_ids ) {
-        const auto& locked_nft = lock_table.get( dgood_id, "dgood not found in lock table" );
-        lock_table.erase( locked_nft );
+// sale proceeds are accrued in proceeds instead of sent with every sale while accrue is set
+ACTION dgoods::setaccrual(const bool& accrue) {
+    require_auth( get_self() );
+
+    actionctx ctx;
+    auto& config_singleton = _getconfig( ctx );
+    // extensions are serialized in order, accrue_proceeds needs next_dgood_id
+    if ( !config_singleton.next_dgood_id.has_value() ) {
+        config_singleton.next_dgood_id.emplace( _nextid( ctx ) );
     }
-    // remove sale listing
-    ask_table.erase( ask );
+    config_singleton.accrue_proceeds.emplace( accrue );
+    _saveconfig( ctx );
 }
 
-// method to log dgood_id and match transaction to action
-ACTION dgoods::logcall(const uint64_t& dgood_id) {
+// pays out everything accrued to account in one transfer
+ACTION dgoods::withdraw(const name& account) {
+    require_auth( account );
+
+    proceeds_index proceeds_table( get_self(), get_self().value );
+    const auto& owed = proceeds_table.get( account.value, "no proceeds to withdraw" );
+    check( owed.amount.amount > 0, "no proceeds to withdraw" );
+    _sendeos( owed.account, owed.amount );
+    proceeds_table.erase( owed );
+}
+
+// pays out up to max_rows accounts with accrued proceeds, callable by anyone
+ACTION dgoods::settle(const name& from,
+                      const uint64_t& max_rows) {
+    proceeds_index proceeds_table( get_self(), get_self().value );
+    // a payee whose transfer fails reverts the call, callers pass over it by starting at the next row
+    auto owed = proceeds_table.lower_bound( from.value );
+    for ( uint64_t rows = 0; owed != proceeds_table.end() && rows < max_rows; rows++ ) {
+        // every row is erased, one that can't be paid would stop every later call at from
+        if ( owed->amount.amount > 0 ) {
+            _sendeos( owed->account, owed->amount );
+        }
+        owed = proceeds_table.erase( owed );
+    }
+}
+
+// method to log the dgood_ids minted and match transaction to action
+ACTION dgoods::logcall(const uint64_t& first_id,
+                       const uint64_t& last_id) {
     require_auth( get_self() );
 }
 
-// Private
-map<name, asset> dgoods::_calcfees(vector<uint64_t> dgood_ids, asset ask_amount, name seller) {
-    map<name, asset> fee_map;
+// moves progress of migrate to the start of its next step
+static void nextstep(dgoods::migration& progress) {
+    uint32_t step = ++progress.step;
+    progress.table = step < dgoods::MIGRATION_STEP_COUNT ? dgoods::MIGRATION_STEPS[step] : "done"_n;
+    progress.next_key = 0;
+    progress.next_scope = 0;
+}
+
+// converts tables written by older versions, resumes where the last call stopped
+ACTION dgoods::migrate(const uint64_t& max_rows) {
+    require_auth( get_self() );
+
+    migration_index migration_table( get_self(), get_self().value );
+    auto progress = migration_table.get_or_default( migration{ MIGRATION_STEPS[0], 0, 0, 0 } );
+    if ( progress.table == "done"_n && progress.step < MIGRATION_STEP_COUNT ) {
+        // steps added since the last migration finished
+        progress.table = MIGRATION_STEPS[progress.step];
+        progress.next_key = 0;
+        progress.next_scope = 0;
+    }
+    uint64_t rows = 0;
+    // dgood rows converted by this call
+    uint64_t converted = 0;
+
+    actionctx ctx;
+    dgood_index dgood_table( get_self(), get_self().value );
+    if ( progress.table == "asks"_n ) {
+        // listed tokens first, their ask is the only place that says which batch a v1 lock belongs to
+        ask_index ask_table( get_self(), get_self().value );
+        auto ask = ask_table.lower_bound( progress.next_key );
+        for ( ; ask != ask_table.end() && rows < max_rows; ask++ ) {
+            for ( auto const& dgood_id: ask->dgood_ids ) {
+                auto dgood_itr = dgood_table.find( dgood_id );
+                if ( dgood_itr != dgood_table.end() ) {
+                    _upgrade( ctx, dgood_table, dgood_itr, ask->batch_id );
+                    converted++;
+                }
+                rows++;
+            }
+            // asks listed by v1 have no entry in byexpiry and bytypeprice, write them again
+            if ( !ask->category_name_id.has_value() ) {
+                asks listing = *ask;
+                listing.category_name_id.emplace( _asktype( ctx, listing.dgood_ids, listing.batch_id ) );
+                ask_table.erase( ask );
+                ask = ask_table.emplace( get_self(), [&]( auto& a ) {
+                    a = listing;
+                });
+            }
+        }
+        if ( ask == ask_table.end() ) {
+            nextstep( progress );
+        } else {
+            progress.next_key = ask->batch_id;
+        }
+    }
+    if ( progress.table == "lockednfts"_n ) {
+        // locks left over have no ask
+        lock_index lock_table( get_self(), get_self().value );
+        auto locked_nft = lock_table.begin();
+        for ( ; locked_nft != lock_table.end() && rows < max_rows; rows++ ) {
+            locked_nft = lock_table.erase( locked_nft );
+        }
+        if ( locked_nft == lock_table.end() ) {
+            nextstep( progress );
+        }
+    }
+    if ( progress.table == "dgood"_n ) {
+        // converted rows leave dgood, the next one to convert is always the first
+        auto dgood_itr = dgood_table.begin();
+        for ( ; dgood_itr != dgood_table.end() && rows < max_rows; rows++ ) {
+            _upgrade( ctx, dgood_table, dgood_itr, UNLOCKED );
+            converted++;
+            dgood_itr = dgood_table.begin();
+        }
+        if ( dgood_itr == dgood_table.end() ) {
+            nextstep( progress );
+        }
+    }
+    if ( progress.table == "dgoodstats"_n ) {
+        // store rev_split in basis points and copy the typestats row of each type,
+        // stats are scoped by category so the cursor is category and token_name
+        auto& typestats_table = _typestatstable( ctx );
+        category_index category_table( get_self(), get_self().value );
+        auto category = category_table.lower_bound( progress.next_scope );
+        uint64_t next_key = progress.next_key;
+        while ( category != category_table.end() && rows < max_rows ) {
+            auto& stats_table = _statstable( ctx, category->category );
+            auto stats = stats_table.lower_bound( next_key );
+            for ( ; stats != stats_table.end() && rows < max_rows; stats++, rows++ ) {
+                if ( !stats->rev_split_bps.has_value() ) {
+                    stats_table.modify( stats, same_payer, [&]( auto& s ) {
+                        s.rev_split_bps.emplace( to_basis_points( s.rev_split ) );
+                    });
+                }
+                if ( typestats_table.find( stats->category_name_id ) == typestats_table.end() ) {
+                    _addtypestats( ctx, *stats );
+                }
+            }
+            if ( stats != stats_table.end() ) {
+                next_key = stats->token_name.value;
+                break;
+            }
+            category++;
+            next_key = 0;
+        }
+        if ( category == category_table.end() ) {
+            nextstep( progress );
+        } else {
+            progress.next_scope = category->category.value;
+            progress.next_key = next_key;
+        }
+    }
+    _addmigrated( "dgood"_n, converted, ctx.v1_bytes, ctx.v2_bytes );
+    migration_table.set( progress, get_self() );
+}
+
+// converts the v1 balances of owner, scopes can't be listed on chain so owners are passed in one at a time
+ACTION dgoods::migrateacct(const name& owner,
+                           const uint64_t& max_rows) {
+    require_auth( get_self() );
+
+    actionctx ctx;
+    account_index account_table( get_self(), owner.value );
+    uint64_t rows = 0;
+    for ( auto acct = account_table.begin(); acct != account_table.end() && rows < max_rows; acct = account_table.begin() ) {
+        _upgrade( ctx, account_table, acct );
+        rows++;
+    }
+    _addmigrated( "accounts"_n, rows, ctx.v1_bytes, ctx.v2_bytes );
+}
+
+// opens the table for scope once per action
+template<typename T>
+static T& scopedtable(vector<std::unique_ptr<T>>& tables, const name& code, const uint64_t& scope) {
+    for ( auto& table: tables ) {
+        if ( table->get_scope() == scope ) {
+            return *table;
+        }
+    }
+    tables.push_back( std::make_unique<T>( code, scope ) );
+    return *tables.back();
+}
+
+// nft rows in byownertype order, then ranges, then v1 dgood rows, at most limit of them
+dgoods::ownedpage dgoods::getowned(const name& owner,
+                                   const std::optional<ownedcursor>& cursor,
+                                   const uint32_t& limit) {
+    check( limit <= 100, "max page size of 100" );
+
+    actionctx ctx;
+    auto& nft_table = _nfttable( ctx );
+    range_index range_table( get_self(), get_self().value );
     dgood_index dgood_table( get_self(), get_self().value );
+    lock_index lock_table( get_self(), get_self().value );
+    auto token_by_owner = nft_table.get_index<"byownertype"_n>();
+    auto range_by_owner = range_table.get_index<"byownertype"_n>();
+    auto dgood_by_owner = dgood_table.get_index<"byowner"_n>();
+    uint128_t last_key = owner_type_key( owner, numeric_limits<uint64_t>::max() );
+
+    auto token = token_by_owner.lower_bound( owner_type_key( owner, 0 ) );
+    auto range = range_by_owner.lower_bound( owner_type_key( owner, 0 ) );
+    auto dgood = dgood_by_owner.lower_bound( owner.value );
+    if ( cursor.has_value() ) {
+        // the cursor is the first entry of the page, the tables before its own are done
+        if ( cursor->table == "nft"_n ) {
+            auto token_itr = nft_table.find( cursor->id );
+            check( token_itr != nft_table.end() && token_itr->owner == owner,
+                   "cursor is no longer owned by owner, start over" );
+            token = token_by_owner.iterator_to( *token_itr );
+        } else if ( cursor->table == "dgoodranges"_n ) {
+            token = token_by_owner.upper_bound( last_key );
+            // ids materialized since are in nft now, the range resumes at the first id left after
+            // them, ranges of one owner and type are in id order
+            uint128_t key = owner_type_key( owner, cursor->category_name_id );
+            auto range_itr = range_table.lower_bound( cursor->id );
+            if ( range_itr != range_table.end() && range_itr->get_owner_type() == key ) {
+                range = range_by_owner.iterator_to( *range_itr );
+            } else {
+                range = range_by_owner.lower_bound( key );
+                while ( range != range_by_owner.end() && range->get_owner_type() == key && range->last_id < cursor->id ) {
+                    range++;
+                }
+            }
+        } else {
+            check( cursor->table == "dgood"_n, "invalid cursor" );
+            token = token_by_owner.upper_bound( last_key );
+            range = range_by_owner.upper_bound( last_key );
+            auto dgood_itr = dgood_table.find( cursor->id );
+            check( dgood_itr != dgood_table.end() && dgood_itr->owner == owner,
+                   "cursor is no longer owned by owner, start over" );
+            dgood = dgood_by_owner.iterator_to( *dgood_itr );
+        }
+    }
+
+    ownedpage page;
+    for ( ; token != token_by_owner.end() && token->get_owner_type() <= last_key && page.tokens.size() < limit; token++ ) {
+        const auto& type = _gettype( ctx, token->category_name_id.value );
+        page.tokens.push_back( _ownedtoken( ctx, type.category, type.token_name, token->id, token->id,
+                                            token->serial_number.value, _islocked( *token ), _geturi( ctx, token->uri_id.value ) ) );
+    }
+    for ( ; range != range_by_owner.end() && range->get_owner_type() <= last_key && page.tokens.size() < limit; range++ ) {
+        const auto& type = _gettype( ctx, range->category_name_id.value );
+        page.tokens.push_back( _ownedtoken( ctx, type.category, type.token_name, range->first_id, range->last_id,
+                                            range->serial_number.value, false, _geturi( ctx, range->uri_id.value ) ) );
+    }
+    for ( ; dgood != dgood_by_owner.end() && dgood->owner == owner && page.tokens.size() < limit; dgood++ ) {
+        bool locked = lock_table.find( dgood->id ) != lock_table.end();
+        page.tokens.push_back( _ownedtoken( ctx, dgood->category, dgood->token_name, dgood->id, dgood->id,
+                                            dgood->serial_number, locked, dgood->relative_uri.value_or( "" ) ) );
+    }
+
+    if ( token != token_by_owner.end() && token->get_owner_type() <= last_key ) {
+        page.cursor = ownedcursor{ "nft"_n, token->category_name_id.value, token->id };
+    } else if ( range != range_by_owner.end() && range->get_owner_type() <= last_key ) {
+        page.cursor = ownedcursor{ "dgoodranges"_n, range->category_name_id.value, range->first_id };
+    } else if ( dgood != dgood_by_owner.end() && dgood->owner == owner ) {
+        page.cursor = ownedcursor{ "dgood"_n, 0, dgood->id };
+    }
+    return page;
+}
+
+vector<dgoods::ownedbalance> dgoods::getbalances(const name& owner) {
+    actionctx ctx;
+    vector<ownedbalance> balances;
+    for ( auto const& balance: _balancetable( ctx, owner ) ) {
+        const auto& type = _gettype( ctx, balance.category_name_id.value );
+        const auto& dgood_stats = _getstats( ctx, type.category, type.token_name );
+        balances.push_back( { type.category, type.token_name, asset( balance.amount, dgood_stats.max_supply.symbol ) } );
+    }
+    // v1 rows not converted yet
+    account_index account_table( get_self(), owner.value );
+    for ( auto const& account: account_table ) {
+        balances.push_back( { account.category, account.token_name, account.amount } );
+    }
+    return balances;
+}
+
+// listings of seller in batch_id order, at most limit of them
+dgoods::askpage dgoods::getasks(const name& seller,
+                                const std::optional<uint64_t>& cursor,
+                                const uint32_t& limit) {
+    check( limit <= 100, "max page size of 100" );
+
+    actionctx ctx;
+    ask_index ask_table( get_self(), get_self().value );
+    auto ask_by_seller = ask_table.get_index<"byseller"_n>();
+    auto ask = ask_by_seller.lower_bound( seller.value );
+    if ( cursor.has_value() ) {
+        const auto& first = ask_table.get( *cursor, "cursor is no longer listed, start over" );
+        check( first.seller == seller, "cursor is no longer listed, start over" );
+        ask = ask_by_seller.iterator_to( first );
+    }
+
+    askpage page;
+    for ( ; ask != ask_by_seller.end() && ask->seller == seller && page.asks.size() < limit; ask++ ) {
+        listing l{ ask->batch_id, ask->dgood_ids, ask->amount, ask->expiration, name(), name() };
+        if ( ask->category_name_id.has_value() && ask->category_name_id.value() != MIXED_TYPES ) {
+            const auto& type = _gettype( ctx, ask->category_name_id.value() );
+            l.category = type.category;
+            l.token_name = type.token_name;
+        }
+        page.asks.push_back( l );
+    }
+    if ( ask != ask_by_seller.end() && ask->seller == seller ) {
+        page.cursor = ask->batch_id;
+    }
+    return page;
+}
+
+// Private
+dgoods::tokenconfigs& dgoods::_getconfig(actionctx& ctx) {
+    if ( !ctx.config.has_value() ) {
+        config_index config_table( get_self(), get_self().value );
+        check( config_table.exists(), "Symbol table does not exist, setconfig first" );
+        ctx.config.emplace( config_table.get() );
+    }
+    return *ctx.config;
+}
+
+// Private
+void dgoods::_saveconfig(actionctx& ctx) {
+    config_index config_table( get_self(), get_self().value );
+    config_table.set( *ctx.config, get_self() );
+}
+
+// Private
+dgoods::nft_index& dgoods::_nfttable(actionctx& ctx) {
+    if ( !ctx.nft_table ) {
+        ctx.nft_table = std::make_unique<nft_index>( get_self(), get_self().value );
+    }
+    return *ctx.nft_table;
+}
+
+// Private
+dgoods::stats_index& dgoods::_statstable(actionctx& ctx, const name& category) {
+    return scopedtable( ctx.stats_tables, get_self(), category.value );
+}
+
+// Private
+const dgoods::dgoodstats& dgoods::_getstats(actionctx& ctx, const name& category, const name& token_name) {
+    return _statstable( ctx, category ).get( token_name.value, "dgood stats not found" );
+}
+
+// Private
+dgoods::type_index& dgoods::_typetable(actionctx& ctx) {
+    if ( !ctx.type_table ) {
+        ctx.type_table = std::make_unique<type_index>( get_self(), get_self().value );
+    }
+    return *ctx.type_table;
+}
+
+// Private
+const dgoods::tokentypes& dgoods::_gettype(actionctx& ctx, const uint64_t& category_name_id) {
+    return _typetable( ctx ).get( category_name_id, "token type does not exist" );
+}
+
+// Private
+const dgoods::dgoodstats& dgoods::_getstats(actionctx& ctx, const uint64_t& category_name_id) {
+    const auto& type = _gettype( ctx, category_name_id );
+    return _getstats( ctx, type.category, type.token_name );
+}
+
+// Private
+dgoods::typestats_index& dgoods::_typestatstable(actionctx& ctx) {
+    if ( !ctx.typestats_table ) {
+        ctx.typestats_table = std::make_unique<typestats_index>( get_self(), get_self().value );
+    }
+    return *ctx.typestats_table;
+}
+
+// Private
+const dgoods::typestats& dgoods::_gettypestats(actionctx& ctx, const uint64_t& category_name_id) {
+    auto& typestats_table = _typestatstable( ctx );
+    auto type_stats = typestats_table.find( category_name_id );
+    if ( type_stats == typestats_table.end() ) {
+        // types created before typestats existed are copied the first time they are used
+        type_stats = _addtypestats( ctx, _getstats( ctx, category_name_id ) );
+    }
+    return *type_stats;
+}
+
+// Private
+dgoods::typestats_index::const_iterator dgoods::_addtypestats(actionctx& ctx, const dgoodstats& dgood_stats) {
+    // the caller may not have paid for the dgoodstats row, the contract pays as it does in migrate
+    return _typestatstable( ctx ).emplace( get_self(), [&]( auto& t ) {
+        t.category_name_id = dgood_stats.category_name_id;
+        t.fungible = dgood_stats.fungible;
+        t.burnable = dgood_stats.burnable;
+        t.sellable = dgood_stats.sellable;
+        t.transferable = dgood_stats.transferable;
+        t.holders_tracked = dgood_stats.holder_count.has_value();
+        t.rev_partner = dgood_stats.rev_partner;
+        t.rev_split_bps = dgood_stats.get_rev_split_bps();
+        t.supply_symbol = dgood_stats.max_supply.symbol;
+    });
+}
+
+// Private
+void dgoods::_addtype(actionctx& ctx, const uint64_t& category_name_id, const name& category, const name& token_name) {
+    // types created before tokentypes existed are added by the first v2 row that refers to them
+    auto& type_table = _typetable( ctx );
+    if ( type_table.find( category_name_id ) == type_table.end() ) {
+        type_table.emplace( get_self(), [&]( auto& t ) {
+            t.category_name_id = category_name_id;
+            t.category = category;
+            t.token_name = token_name;
+        });
+    }
+}
+
+// Private
+dgoods::balance_index& dgoods::_balancetable(actionctx& ctx, const name& owner) {
+    return scopedtable( ctx.balance_tables, get_self(), owner.value );
+}
+
+// Private
+dgoods::balance_index::const_iterator dgoods::_findbalance(actionctx& ctx, const name& owner,
+                                                           const uint64_t& category_name_id) {
+    auto& balance_table = _balancetable( ctx, owner );
+    auto balance = balance_table.find( category_name_id );
+    if ( balance == balance_table.end() ) {
+        account_index account_table( get_self(), owner.value );
+        auto acct = account_table.find( category_name_id );
+        if ( acct != account_table.end() ) {
+            balance = _upgrade( ctx, account_table, acct );
+        }
+    }
+    return balance;
+}
+
+// Private
+vector<dgoods::payout> dgoods::_calcfees(actionctx& ctx, const vector<uint64_t>& dgood_ids, const asset& ask_amount, const name& seller) {
+    PROFILE_SCOPE();
+    vector<payout> payouts;
+    // every rev_partner and the seller at most
+    payouts.reserve( dgood_ids.size() + 1 );
+    auto& nft_table = _nfttable( ctx );
     int64_t tot_fees = 0;
     for ( auto const& dgood_id: dgood_ids ) {
-        const auto& token = dgood_table.get( dgood_id, "token does not exist" );
+        const auto& token = nft_table.get( dgood_id, "token does not exist" );
 
-        stats_index stats_table( get_self(), token.category.value );
-        const auto& dgood_stats = stats_table.get( token.token_name.value, "dgood stats not found" );
+        const auto& type_stats = _gettypestats( ctx, token.category_name_id.value );
 
-        name rev_partner = dgood_stats.rev_partner;
-        if ( dgood_stats.rev_split == 0.0 ) {
+        name rev_partner = type_stats.rev_partner;
+        uint16_t rev_split_bps = type_stats.rev_split_bps;
+        if ( rev_split_bps == 0 ) {
             continue;
         }
 
-        double fee = static_cast<double>(ask_amount.amount) * dgood_stats.rev_split / static_cast<double>( dgood_ids.size() );
-        asset fee_asset(fee, ask_amount.symbol);
-        auto ret_val = fee_map.insert({rev_partner, fee_asset});
-        tot_fees += fee_asset.amount;
-        if ( ret_val.second == false ) {
-            fee_map[rev_partner] += fee_asset;
-        }
-    }
-    //add seller to fee_map minus fees
-    asset seller_amount(ask_amount.amount - tot_fees, ask_amount.symbol);
-    auto ret_val = fee_map.insert({seller, seller_amount});
-    if ( ret_val.second == false ) {
-        fee_map[seller] += seller_amount;
+        // each token is an equal share of the ask, rounded down, 128 bits so amount * bps can't overflow
+        int64_t fee = static_cast<int64_t>( static_cast<int128_t>( ask_amount.amount ) * rev_split_bps /
+                                            ( BASIS_POINTS * static_cast<int64_t>( dgood_ids.size() ) ) );
+        _addpayout( payouts, rev_partner, asset( fee, ask_amount.symbol ) );
+        tot_fees += fee;
     }
-    return fee_map;
+    //add seller to payouts minus fees
+    _addpayout( payouts, seller, asset( ask_amount.amount - tot_fees, ask_amount.symbol ) );
+    return payouts;
 }
 
 // Private
-void dgoods::_changeowner(const name& from, const name& to, const vector<uint64_t>& dgood_ids, const string& memo, const bool& istransfer) {
+void dgoods::_changeowner(actionctx& ctx, const name& from, const name& to, const vector<uint64_t>& dgood_ids, const bool& istransfer) {
+    PROFILE_SCOPE();
     check (dgood_ids.size() <= 20, "max batch size of 20");
+    // balances move once per token type, not once per token
+    vector<typebatch> batches;
+    _moveowner( ctx, from, to, dgood_ids, istransfer, batches );
+
+    // notifiy both parties
+    require_recipient( from );
+    require_recipient( to );
+    for ( auto const& batch: batches ) {
+        _sub_balance(ctx, from, batch.category_name_id, batch.quantity);
+        _add_balance(ctx, to, get_self(), batch.category_name_id, batch.quantity);
+    }
+}
+
+// Private
+void dgoods::_moveowner(actionctx& ctx, const name& from, const name& to, const vector<uint64_t>& dgood_ids,
+                        const bool& istransfer, vector<typebatch>& batches) {
+    PROFILE_SCOPE();
     // loop through vector of dgood_ids, check token exists
-    dgood_index dgood_table( get_self(), get_self().value );
-    lock_index lock_table( get_self(), get_self().value );
+    auto& nft_table = _nfttable( ctx );
     for ( auto const& dgood_id: dgood_ids ) {
-        const auto& token = dgood_table.get( dgood_id, "token does not exist" );
+        // a sale releases every token of the ask, its batch_id is the first of its dgood_ids
+        auto token_itr = _findtoken( ctx, dgood_id, istransfer ? UNLOCKED : dgood_ids[0] );
+        if ( token_itr == nft_table.end() ) {
+            token_itr = _materialize( ctx, dgood_id, from );
+        }
+        const auto& token = *token_itr;
 
-        stats_index stats_table( get_self(), token.category.value );
-        const auto& dgood_stats = stats_table.get( token.token_name.value, "dgood stats not found" );
+        const auto& type_stats = _gettypestats( ctx, token.category_name_id.value );
 
         if ( istransfer ) {
             check( token.owner == from, "must be token owner" );
-            check( dgood_stats.transferable == true, "not transferable");
-            auto locked_nft = lock_table.find( dgood_id );
-            check( locked_nft == lock_table.end(), "token locked, cannot transfer");
+            check( type_stats.transferable == true, "not transferable");
+            check( !_islocked( token ), "token locked, cannot transfer");
         }
 
-        // notifiy both parties
-        require_recipient( from );
-        require_recipient( to );
-        dgood_table.modify( token, same_payer, [&] (auto& t ) {
+        nft_table.modify( token, same_payer, [&] (auto& t ) {
             t.owner = to;
+            // a sold token leaves its ask
+            t.lock = 0;
         });
-
         // amount 1, precision 0 for NFT
-        asset quantity(1, dgood_stats.max_supply.symbol);
-        _sub_balance(from, dgood_stats.category_name_id, quantity);
-        _add_balance(to, get_self(), token.category, token.token_name, dgood_stats.category_name_id, quantity);
+        _addtobatch( batches, type_stats.category_name_id, asset( 1, type_stats.supply_symbol ) );
+    }
+}
+
+// Private
+string dgoods::_geturi(actionctx& ctx, const uint64_t& uri_id) {
+    if ( uri_id == 0 ) {
+        return string();
     }
+    return _uritable( ctx ).get( uri_id, "uri does not exist" ).uri;
+}
+
+// Private
+dgoods::ownedtoken dgoods::_ownedtoken(actionctx& ctx, const name& category, const name& token_name, const uint64_t& id,
+                                       const uint64_t& last_id, const uint64_t& serial_number, const bool& locked,
+                                       const string& relative_uri) {
+    const auto& dgood_stats = _getstats( ctx, category, token_name );
+    return { id, last_id, serial_number, category, token_name, dgood_stats.burnable, dgood_stats.sellable,
+             dgood_stats.transferable, locked, dgood_stats.base_uri + relative_uri };
 }
 
 // Private
-void dgoods::_checkasset(const asset& amount, const bool& fungible) {
+void dgoods::_sendeos(const name& account, const asset& amount) {
+    action( permission_level{ get_self(), name("active") },
+            name("eosio.token"), name("transfer"),
+            make_tuple( get_self(), account, amount, string("sale of dgood") ) ).send();
+    PROFILE_ADD( inline_actions, 1 );
+}
+
+// Private
+void dgoods::_addpayout(vector<payout>& payouts, const name& account, const asset& amount) {
+    // few accounts take part in a sale, a linear search beats a map
+    for ( auto& p: payouts ) {
+        if ( p.account == account ) {
+            p.amount += amount;
+            return;
+        }
+    }
+    payouts.push_back( { account, amount } );
+}
+
+// Private
+void dgoods::_addtobatch(vector<typebatch>& batches, const uint64_t& category_name_id, const asset& quantity) {
+    for ( auto& batch: batches ) {
+        if ( batch.category_name_id == category_name_id ) {
+            batch.quantity += quantity;
+            return;
+        }
+    }
+    batches.push_back( { category_name_id, quantity } );
+}
+
+// Private
+void dgoods::_addtoowner(vector<ownerbatch>& owners, const name& owner, const uint64_t& category_name_id, const asset& quantity) {
+    for ( auto& o: owners ) {
+        if ( o.owner == owner ) {
+            _addtobatch( o.batches, category_name_id, quantity );
+            return;
+        }
+    }
+    owners.push_back( { owner, { { category_name_id, quantity } } } );
+}
+
+// Private
+void dgoods::_checkasset(actionctx& ctx, const asset& amount, const bool& fungible) {
     auto sym = amount.symbol;
     if (fungible) {
         check( amount.amount > 0, "amount must be positive" );
@@ -432,76 +1438,494 @@ void dgoods::_checkasset(const asset& amount, const bool& fungible) {
         check( amount.amount >= 1, "NFT amount must be >= 1" );
     }
 
-    config_index config_table(get_self(), get_self().value);
-    auto config_singleton  = config_table.get();
+    const auto& config_singleton = _getconfig( ctx );
     check( config_singleton.symbol.raw() == sym.code().raw(), "Symbol must match symbol in config" );
     check( amount.is_valid(), "invalid amount" );
 }
 
 // Private
-void dgoods::_mint(const name& to,
+bool dgoods::_islocked(const nft& token) {
+    return token.lock.value != 0;
+}
+
+// Private
+void dgoods::_unlock(nft_index& nft_table, const nft& token) {
+    nft_table.modify( token, same_payer, [&]( auto& t ) {
+        t.lock = 0;
+    });
+}
+
+// Private
+void dgoods::_unlockask(actionctx& ctx, const asks& ask) {
+    auto& nft_table = _nfttable( ctx );
+    for ( auto const& dgood_id: ask.dgood_ids ) {
+        auto token_itr = _findtoken( ctx, dgood_id, ask.batch_id );
+        check( token_itr != nft_table.end(), "token does not exist" );
+        _unlock( nft_table, *token_itr );
+    }
+}
+
+// Private
+dgoods::nft_index::const_iterator dgoods::_findtoken(actionctx& ctx, const uint64_t& dgood_id, const uint64_t& batch_id) {
+    auto& nft_table = _nfttable( ctx );
+    auto token_itr = nft_table.find( dgood_id );
+    if ( token_itr == nft_table.end() ) {
+        dgood_index dgood_table( get_self(), get_self().value );
+        auto dgood_itr = dgood_table.find( dgood_id );
+        if ( dgood_itr != dgood_table.end() ) {
+            token_itr = _upgrade( ctx, dgood_table, dgood_itr, batch_id );
+        }
+    }
+    return token_itr;
+}
+
+// Private
+uint64_t dgoods::_asktype(actionctx& ctx, const vector<uint64_t>& dgood_ids, const uint64_t& batch_id) {
+    auto& nft_table = _nfttable( ctx );
+    uint64_t category_name_id = MIXED_TYPES;
+    for ( auto const& dgood_id: dgood_ids ) {
+        auto token_itr = _findtoken( ctx, dgood_id, batch_id );
+        if ( token_itr == nft_table.end() ) {
+            return MIXED_TYPES;
+        }
+        if ( category_name_id != MIXED_TYPES && token_itr->category_name_id.value != category_name_id ) {
+            return MIXED_TYPES;
+        }
+        category_name_id = token_itr->category_name_id.value;
+    }
+    return category_name_id;
+}
+
+// Private
+dgoods::nft_index::const_iterator dgoods::_upgrade(actionctx& ctx, dgood_index& dgood_table,
+                                                   dgood_index::const_iterator dgood_itr, const uint64_t& batch_id) {
+    const auto& dgood_stats = _getstats( ctx, dgood_itr->category, dgood_itr->token_name );
+    _addtype( ctx, dgood_stats.category_name_id, dgood_itr->category, dgood_itr->token_name );
+
+    check( dgood_itr->id <= MAX_TOKEN_NUMBER && dgood_itr->serial_number <= MAX_TOKEN_NUMBER,
+           "dgood_id or serial_number too large for nft" );
+    nft token;
+    token.id = dgood_itr->id;
+    token.serial_number = dgood_itr->serial_number;
+    token.owner = dgood_itr->owner;
+    token.category_name_id = dgood_stats.category_name_id;
+    token.lock = 0;
+    token.uri_id = _intern( ctx, dgood_itr->relative_uri.value_or( "" ), 1, get_self() );
+
+    // byowner
+    ctx.v1_bytes += pack_size( *dgood_itr ) + ROW_OVERHEAD + IDX64_OVERHEAD;
+    // a lockednfts row doesn't say which ask holds the token, only callers acting on that ask know it
+    lock_index lock_table( get_self(), get_self().value );
+    auto locked_nft = lock_table.find( token.id );
+    if ( locked_nft != lock_table.end() ) {
+        check( batch_id != UNLOCKED, "token locked" );
+        token.lock = 1;
+        ctx.v1_bytes += pack_size( *locked_nft ) + ROW_OVERHEAD;
+        lock_table.erase( locked_nft );
+    }
+
+    dgood_table.erase( dgood_itr );
+    // the owner may not have authorized this action, the contract pays as it does in migrate
+    auto token_itr = _nfttable( ctx ).emplace( get_self(), [&]( auto& t ) {
+        t = token;
+    });
+    // byownertype and bytypeserial
+    ctx.v2_bytes += pack_size( *token_itr ) + ROW_OVERHEAD + 2 * IDX128_OVERHEAD;
+    return token_itr;
+}
+
+// Private
+dgoods::balance_index::const_iterator dgoods::_upgrade(actionctx& ctx, account_index& account_table,
+                                                       account_index::const_iterator acct_itr) {
+    _addtype( ctx, acct_itr->category_name_id, acct_itr->category, acct_itr->token_name );
+
+    balances balance;
+    balance.category_name_id = acct_itr->category_name_id;
+    balance.amount = acct_itr->amount.amount;
+
+    ctx.v1_bytes += pack_size( *acct_itr ) + ROW_OVERHEAD;
+    account_table.erase( acct_itr );
+    // v1 balances were always billed to the contract
+    auto balance_itr = _balancetable( ctx, name( account_table.get_scope() ) ).emplace( get_self(), [&]( auto& b ) {
+        b = balance;
+    });
+    ctx.v2_bytes += pack_size( *balance_itr ) + ROW_OVERHEAD;
+    return balance_itr;
+}
+
+// Private
+void dgoods::_addmigrated(const name& table, const uint64_t& rows, const uint64_t& v1_bytes, const uint64_t& v2_bytes) {
+    if ( rows == 0 ) return;
+
+    migrated_index migrated_table( get_self(), get_self().value );
+    auto report = migrated_table.find( table.value );
+    if ( report == migrated_table.end() ) {
+        migrated_table.emplace( get_self(), [&]( auto& m ) {
+            m.table = table;
+            m.rows = rows;
+            m.v1_bytes = v1_bytes;
+            m.v2_bytes = v2_bytes;
+        });
+    } else {
+        migrated_table.modify( report, same_payer, [&]( auto& m ) {
+            m.rows += rows;
+            m.v1_bytes += v1_bytes;
+            m.v2_bytes += v2_bytes;
+        });
+    }
+}
+
+// Private
+uint64_t dgoods::_nextid(actionctx& ctx) {
+    // ids are shared between v1 rows, nft rows and ranges that have not been materialized yet
+    // only used to seed next_dgood_id for configs written before it existed
+    dgood_index dgood_table( get_self(), get_self().value );
+    uint64_t next_id = std::max( dgood_table.available_primary_key(), _nfttable( ctx ).available_primary_key() );
+    range_index range_table( get_self(), get_self().value );
+    auto last_range = range_table.rbegin();
+    if ( last_range != range_table.rend() && last_range->last_id >= next_id ) {
+        next_id = last_range->last_id + 1;
+    }
+    return next_id;
+}
+
+// Private
+// ram_payer is who signed the transfer, listing or burn cutting the token out, it pays for the row
+// split off before it as it pays for the token's own row
+dgoods::nft dgoods::_takefromrange(actionctx& ctx, const uint64_t& dgood_id, const name& ram_payer) {
+    range_index range_table( get_self(), get_self().value );
+    // ranges are keyed by last id so the first range ending at or after dgood_id is the only candidate
+    auto range = range_table.lower_bound( dgood_id );
+    check( range != range_table.end() && range->first_id <= dgood_id, "token does not exist" );
+
+    nft token;
+    token.id = dgood_id;
+    token.serial_number = range->serial_number.value + ( dgood_id - range->first_id );
+    token.owner = range->owner;
+    token.category_name_id = range->category_name_id;
+    token.lock = 0;
+    token.uri_id = range->uri_id;
+
+    // the token holds a reference to its uri, as does every range row
+    int64_t refs = 1;
+    if ( range->first_id == range->last_id ) {
+        range_table.erase( range );
+        refs--;
+    } else if ( dgood_id == range->first_id ) {
+        range_table.modify( range, same_payer, [&]( auto& r ) {
+            r.first_id++;
+            r.serial_number = r.serial_number.value + 1;
+        });
+    } else {
+        // split off the ids before dgood_id, primary key of the remainder moves to dgood_id - 1
+        dgoodranges head = *range;
+        head.last_id = dgood_id - 1;
+        if ( dgood_id == range->last_id ) {
+            range_table.erase( range );
+            refs--;
+        } else {
+            range_table.modify( range, same_payer, [&]( auto& r ) {
+                r.serial_number = r.serial_number.value + ( dgood_id + 1 - r.first_id );
+                r.first_id = dgood_id + 1;
+            });
+        }
+        range_table.emplace( ram_payer, [&]( auto& r ) {
+            r = head;
+        });
+        refs++;
+    }
+    _adduri( ctx, token.uri_id.value, refs );
+    return token;
+}
+
+// Private
+// the ids of the range holding dgood_id that come before it become a range of their own, billed
+// to ram_payer, so that a range starts at dgood_id
+void dgoods::_splitrange(actionctx& ctx, range_index& range_table, const uint64_t& dgood_id, const name& ram_payer) {
+    auto range = range_table.lower_bound( dgood_id );
+    if ( range == range_table.end() || range->first_id >= dgood_id ) {
+        return;
+    }
+    // the primary key is last_id, the remainder keeps it
+    dgoodranges head = *range;
+    head.last_id = dgood_id - 1;
+    range_table.modify( range, same_payer, [&]( auto& r ) {
+        r.serial_number = r.serial_number.value + ( dgood_id - r.first_id );
+        r.first_id = dgood_id;
+    });
+    range_table.emplace( ram_payer, [&]( auto& r ) {
+        r = head;
+    });
+    _adduri( ctx, head.uri_id.value, 1 );
+}
+
+// Private
+// visits the ranges and tokens of a type from from_serial on in serial order, so where a call
+// stops is where the next starts, at most max_rows rows. A range holding from_serial is split
+// there first, which counts as a row. visit_range and visit_token get the index and the row and
+// return the row after it; returns from_serial of the next call, empty once every row was visited
+template<typename VisitRange, typename VisitToken>
+std::optional<uint64_t> dgoods::_walktype(actionctx& ctx, const uint64_t& category_name_id, const uint64_t& from_serial,
+                                          const uint64_t& max_rows, const name& ram_payer,
+                                          VisitRange&& visit_range, VisitToken&& visit_token) {
+    uint128_t first_key = type_serial_key( category_name_id, from_serial );
+    uint128_t last_key = type_serial_key( category_name_id, numeric_limits<uint64_t>::max() );
+    uint64_t rows = 0;
+
+    range_index range_table( get_self(), get_self().value );
+    auto range_by_type = range_table.get_index<"bytypeserial"_n>();
+    auto range = range_by_type.lower_bound( first_key );
+    if ( range != range_by_type.begin() && max_rows > 0 ) {
+        auto before = range;
+        before--;
+        uint64_t kept = from_serial - before->serial_number.value;
+        if ( before->category_name_id.value == category_name_id && before->last_id - before->first_id >= kept ) {
+            _splitrange( ctx, range_table, before->first_id + kept, ram_payer );
+            range = range_by_type.lower_bound( first_key );
+            rows++;
+        }
+    }
+
+    auto& nft_table = _nfttable( ctx );
+    auto by_type = nft_table.get_index<"bytypeserial"_n>();
+    auto token = by_type.lower_bound( first_key );
+    auto ranges_left = [&]() { return range != range_by_type.end() && range->get_type_serial() <= last_key; };
+    auto tokens_left = [&]() { return token != by_type.end() && token->get_type_serial() <= last_key; };
+    for ( ; ( ranges_left() || tokens_left() ) && rows < max_rows; rows++ ) {
+        if ( ranges_left() && ( !tokens_left() || range->serial_number.value < token->serial_number.value ) ) {
+            range = visit_range( range_by_type, range );
+        } else {
+            token = visit_token( by_type, token );
+        }
+    }
+    std::optional<uint64_t> next_serial;
+    if ( ranges_left() ) {
+        next_serial = range->serial_number.value;
+    }
+    if ( tokens_left() && ( !next_serial || token->serial_number.value < *next_serial ) ) {
+        next_serial = token->serial_number.value;
+    }
+    return next_serial;
+}
+
+// Private
+dgoods::nft_index::const_iterator dgoods::_materialize(actionctx& ctx, const uint64_t& dgood_id,
+                                                       const name& ram_payer) {
+    nft token = _takefromrange( ctx, dgood_id, ram_payer );
+    return _nfttable( ctx ).emplace( ram_payer, [&]( auto& t ) {
+        t = token;
+    });
+}
+
+// Private
+dgoods::uri_index& dgoods::_uritable(actionctx& ctx) {
+    if ( !ctx.uri_table ) {
+        ctx.uri_table = std::make_unique<uri_index>( get_self(), get_self().value );
+    }
+    return *ctx.uri_table;
+}
+
+// Private
+// id of uri in uris after adding refs references to it, 0 for an empty uri
+uint64_t dgoods::_intern(actionctx& ctx, const string& uri, const uint64_t& refs, const name& ram_payer) {
+    if ( uri.empty() ) {
+        return 0;
+    }
+    auto& uri_table = _uritable( ctx );
+    uint64_t hash = uri_hash( uri );
+    auto by_hash = uri_table.get_index<"byhash"_n>();
+    // a truncated hash may be shared, only the uri itself tells rows apart
+    for ( auto existing = by_hash.lower_bound( hash ); existing != by_hash.end() && existing->hash == hash; existing++ ) {
+        if ( existing->uri == uri ) {
+            by_hash.modify( existing, same_payer, [&]( auto& u ) {
+                u.refs += refs;
+            });
+            return existing->uri_id;
+        }
+    }
+
+    // 0 stands for no uri
+    uint64_t uri_id = std::max( uri_table.available_primary_key(), uint64_t( 1 ) );
+    auto row = uri_table.emplace( ram_payer, [&]( auto& u ) {
+        u.uri_id = uri_id;
+        u.uri = uri;
+        u.hash = hash;
+        u.refs = refs;
+    });
+    // byhash
+    ctx.v2_bytes += pack_size( *row ) + ROW_OVERHEAD + IDX64_OVERHEAD;
+    return uri_id;
+}
+
+// Private
+// the row is erased once no reference is left
+void dgoods::_adduri(actionctx& ctx, const uint64_t& uri_id, const int64_t& delta) {
+    if ( uri_id == 0 ) {
+        return;
+    }
+    auto& uri_table = _uritable( ctx );
+    const auto& row = uri_table.get( uri_id, "uri does not exist" );
+    check( delta >= 0 || row.refs >= static_cast<uint64_t>( -delta ), "uri has fewer references" );
+    uint64_t refs = row.refs + delta;
+    if ( refs == 0 ) {
+        uri_table.erase( row );
+    } else if ( delta != 0 ) {
+        uri_table.modify( row, same_payer, [&]( auto& u ) {
+            u.refs = refs;
+        });
+    }
+}
+
+// Private
+uint64_t dgoods::_reserveids(actionctx& ctx, const uint64_t& count) {
+    auto& config_singleton = _getconfig( ctx );
+    if ( !config_singleton.next_dgood_id.has_value() ) {
+        config_singleton.next_dgood_id.emplace( _nextid( ctx ) );
+    }
+    // ids first_id..first_id + count - 1 now belong to the caller
+    uint64_t first_id = config_singleton.next_dgood_id.value();
+    check( first_id <= MAX_TOKEN_NUMBER && count <= MAX_TOKEN_NUMBER + 1 - first_id, "no dgood_id left" );
+    config_singleton.next_dgood_id.value() += count;
+    _saveconfig( ctx );
+    return first_id;
+}
+
+// Private
+void dgoods::_mint(actionctx& ctx,
+                   const name& to,
                    const name& issuer,
-                   const name& category,
-                   const name& token_name,
+                   const uint64_t& category_name_id,
                    const asset& issued_supply,
+                   const asset& quantity,
                    const string& relative_uri) {
+    PROFILE_SCOPE();
+
+    auto& nft_table = _nfttable( ctx );
+    uint64_t first_id = _reserveids( ctx, quantity.amount );
+    uint64_t last_id = first_id + quantity.amount - 1;
+    // every token of the batch shares one uris row
+    uint64_t uri_id = _intern( ctx, relative_uri, quantity.amount, issuer );
+    for ( int64_t i = 0; i < quantity.amount; i++ ) {
+        nft_table.emplace( issuer, [&]( auto& t ) {
+            t.id = first_id + i;
+            // used to keep track of serial number when minting multiple
+            t.serial_number = issued_supply.amount + i + 1;
+            t.owner = to;
+            t.category_name_id = category_name_id;
+            t.lock = 0;
+            t.uri_id = uri_id;
+        });
+    }
+    // one log for the whole batch
+    SEND_INLINE_ACTION( *this, logcall, { { get_self(), "active"_n } }, { first_id, last_id } );
+    PROFILE_ADD( inline_actions, 1 );
+}
 
-    dgood_index dgood_table( get_self(), get_self().value);
-    auto dgood_id = dgood_table.available_primary_key();
-    if ( relative_uri.empty() ) {
-        dgood_table.emplace( issuer, [&]( auto& dg) {
-            dg.id = dgood_id;
-            dg.serial_number = issued_supply.amount + 1;
-            dg.owner = to;
-            dg.category = category;
-            dg.token_name = token_name;
+// Private
+void dgoods::_add_balance(actionctx& ctx, const name& owner, const name& ram_payer, const uint64_t& category_name_id,
+                         const asset& quantity) {
+    PROFILE_SCOPE();
+    auto& to_balance = _balancetable( ctx, owner );
+    auto balance = _findbalance( ctx, owner, category_name_id );
+    if ( balance == to_balance.end() ) {
+        balance = to_balance.emplace( ram_payer, [&]( auto& b ) {
+            b.category_name_id = category_name_id;
+            b.amount = quantity.amount;
         });
     } else {
-        dgood_table.emplace( issuer, [&]( auto& dg ) {
-            dg.id = dgood_id;
-            dg.serial_number = issued_supply.amount + 1;
-            dg.owner = to;
-            dg.category = category;
-            dg.token_name = token_name;
-            dg.relative_uri = relative_uri;
+        to_balance.modify( balance, same_payer, [&]( auto& b ) {
+            b.amount += quantity.amount;
         });
     }
-    SEND_INLINE_ACTION( *this, logcall, { { get_self(), "active"_n } }, { dgood_id } );
+    _setholder( ctx, owner, ram_payer, category_name_id, balance->amount );
 }
 
 // Private
-void dgoods::_add_balance(const name& owner, const name& ram_payer, const name& category, const name& token_name,
-                         const uint64_t& category_name_id, const asset& quantity) {
-    account_index to_account( get_self(), owner.value );
-    auto acct = to_account.find( category_name_id );
-    if ( acct == to_account.end() ) {
-        to_account.emplace( ram_payer, [&]( auto& a ) {
-            a.category_name_id = category_name_id;
-            a.category = category;
-            a.token_name = token_name;
-            a.amount = quantity;
-        });
+void dgoods::_sub_balance(actionctx& ctx, const name& owner, const uint64_t& category_name_id, const asset& quantity) {
+    PROFILE_SCOPE();
+
+    auto& from_balance = _balancetable( ctx, owner );
+    auto balance = _findbalance( ctx, owner, category_name_id );
+    check( balance != from_balance.end(), "token does not exist in account" );
+    check( balance->amount >= quantity.amount, "quantity is more than account balance");
+
+    int64_t amount = balance->amount - quantity.amount;
+    if ( amount == 0 ) {
+        from_balance.erase( balance );
     } else {
-        to_account.modify( acct, same_payer, [&]( auto& a ) {
-            a.amount += quantity;
+        from_balance.modify( balance, same_payer, [&]( auto& b ) {
+            b.amount = amount;
         });
     }
+    _setholder( ctx, owner, get_self(), category_name_id, amount );
 }
 
 // Private
-void dgoods::_sub_balance(const name& owner, const uint64_t& category_name_id, const asset& quantity) {
+// mirrors the balance of owner into holders, a zero amount removes the holder
+void dgoods::_setholder(actionctx& ctx, const name& owner, const name& ram_payer, const uint64_t& category_name_id,
+                        const int64_t& amount) {
+    if ( !_gettypestats( ctx, category_name_id ).holders_tracked ) {
+        return;
+    }
+    const auto& dgood_stats = _getstats( ctx, category_name_id );
+
+    holder_index holder_table( get_self(), category_name_id );
+    auto holder = holder_table.find( owner.value );
+    int64_t held = holder == holder_table.end() ? 0 : holder->amount;
+    if ( amount != held ) {
+        // while addholders runs, counts what the holders found so far hold
+        auto& fill_table = _holderfilltable( ctx );
+        auto fill = fill_table.find( category_name_id );
+        if ( fill != fill_table.end() ) {
+            fill_table.modify( fill, same_payer, [&]( auto& f ) {
+                f.held += amount - held;
+            });
+        }
+    }
+    if ( holder != holder_table.end() && amount != 0 ) {
+        holder_table.modify( holder, same_payer, [&]( auto& h ) {
+            h.amount = amount;
+        });
+        return;
+    }
 
-    account_index from_account( get_self(), owner.value );
-    const auto& acct = from_account.get( category_name_id, "token does not exist in account" );
-    check( acct.amount.amount >= quantity.amount, "quantity is more than account balance");
+    if ( holder == holder_table.end() && amount == 0 ) {
+        return;
+    }
 
-    if ( acct.amount.amount == quantity.amount ) {
-        from_account.erase( acct );
-    } else {
-        from_account.modify( acct, same_payer, [&]( auto& a ) {
-            a.amount -= quantity;
+    uint64_t holder_count = dgood_stats.holder_count.value();
+    if ( holder == holder_table.end() ) {
+        holder_table.emplace( ram_payer, [&]( auto& h ) {
+            h.owner = owner;
+            h.amount = amount;
         });
+        holder_count++;
+    } else {
+        holder_table.erase( holder );
+        holder_count--;
     }
+    _statstable( ctx, _gettype( ctx, category_name_id ).category ).modify( dgood_stats, same_payer, [&]( auto& s ) {
+        s.holder_count.value() = holder_count;
+    });
+}
+
+// Private
+dgoods::holderfill_index& dgoods::_holderfilltable(actionctx& ctx) {
+    if ( !ctx.holderfill_table ) {
+        ctx.holderfill_table = std::make_unique<holderfill_index>( get_self(), get_self().value );
+    }
+    return *ctx.holderfill_table;
+}
+
+// execute_action only takes actions returning void, an action returning a value is unpacked the
+// same way and what it returns is packed as the action return value
+template<typename R, typename... Args>
+static void execute_returning(const name& receiver, const name& code, R (dgoods::*act)(Args...)) {
+    auto args = unpack_action_data<std::tuple<std::decay_t<Args>...>>();
+    dgoods inst( receiver, code, datastream<const char*>( nullptr, 0 ) );
+    R result = std::apply( [&]( auto&... a ) { return ( inst.*act )( a... ); }, args );
+    auto packed = pack( result );
+    set_action_return_value( packed.data(), packed.size() );
 }
 
 extern "C" {
@@ -510,7 +1934,22 @@ extern "C" {
 
         if ( code == self ) {
             switch( action ) {
-                EOSIO_DISPATCH_HELPER( dgoods, (setconfig)(create)(issue)(burnnft)(burnft)(transfernft)(transferft)(listsalenft)(closesalenft)(logcall) )
+                EOSIO_DISPATCH_HELPER( dgoods, (setconfig)(create)(issue)(issuerange)(burnnft)(burnft)(transfernft)(transfernfts)(trackholders)(addholders)(transferft)(airdropft)(listsalenft)(closesalenft)(sweepexpired)(setaccrual)(withdraw)(settle)(queuejob)(process)(canceljob)(logcall)(migrate)(migrateacct) )
+                case name("burntype").value:
+                    execute_returning( name(receiver), name(code), &dgoods::burntype );
+                    break;
+                case name("seturis").value:
+                    execute_returning( name(receiver), name(code), &dgoods::seturis );
+                    break;
+                case name("getowned").value:
+                    execute_returning( name(receiver), name(code), &dgoods::getowned );
+                    break;
+                case name("getbalances").value:
+                    execute_returning( name(receiver), name(code), &dgoods::getbalances );
+                    break;
+                case name("getasks").value:
+                    execute_returning( name(receiver), name(code), &dgoods::getasks );
+                    break;
             }
         }
 
@@ -519,6 +1958,7 @@ extern "C" {
                 execute_action( name(receiver), name(code), &dgoods::buynft );
             }
         }
+        PROFILE_REPORT( name(action) );
     }
 }
 
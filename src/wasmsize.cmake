@@ -0,0 +1,6 @@
+# checks the size of WASM against BUDGET bytes, used by the dgoods_size target
+file( SIZE ${WASM} size )
+message( STATUS "dgoods.wasm is ${size} bytes" )
+if( BUDGET GREATER 0 AND size GREATER BUDGET )
+   message( FATAL_ERROR "dgoods.wasm is ${size} bytes, over the budget of ${BUDGET}" )
+endif()
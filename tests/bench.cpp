@@ -0,0 +1,191 @@
+// wall time of single dgoods actions on a chain already holding n tokens, with the db calls,
+// bytes and RAM of each action as counters. Sizes run from 1000 tokens up to DGOODS_BENCH_MAX,
+// 100000 by default; the in-memory chain takes about 0.5 KB per token, so 10M needs some 5 GB.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "tester.hpp"
+
+namespace {
+
+    constexpr name category = "tickets"_n;
+    constexpr name token_name = "gold"_n;
+    constexpr name alice = "alice"_n;
+    constexpr name bob = "bob"_n;
+    const name holders[] = { "alice"_n, "bob"_n, "carol"_n, "dave"_n };
+
+    // one chain at a time, rebuilt when the size changes since every benchmark of a size runs
+    // before the next size
+    struct populated {
+        uint64_t size = 0;
+        std::unique_ptr<tester> t;
+    };
+
+    tester& chain_with(uint64_t size) {
+        static populated p;
+        if ( p.t && p.size == size ) {
+            return *p.t;
+        }
+        p.t.reset();
+        p.t = std::make_unique<tester>();
+        p.size = size;
+        auto& t = *p.t;
+        t.create( category, token_name, false, 1000000000000 );
+        uint64_t batch = 0;
+        for ( uint64_t issued = 0; issued < size; issued += 100, batch++ ) {
+            t.issue( holders[batch % 4], category, token_name, std::min<uint64_t>( 100, size - issued ) );
+        }
+        t.fund( bob, 100000000000 );
+        return t;
+    }
+
+    std::vector<uint64_t> first_owned(tester& t, name owner) {
+        std::vector<uint64_t> ids;
+        auto page = t.query<dgoods::ownedpage>( "getowned"_n, owner, std::optional<dgoods::ownedcursor>(), uint32_t( 100 ) );
+        for ( const auto& token: page.tokens ) {
+            if ( !token.locked ) ids.push_back( token.id );
+        }
+        return ids;
+    }
+
+    void none() {}
+
+    // runs action once per iteration and reports its average db calls, bytes and RAM, before and
+    // after run around it untimed and uncounted
+    template<typename Action, typename Before = void (*)(), typename After = void (*)()>
+    void measure(benchmark::State& state, tester& t, Action&& action, Before&& before = none, After&& after = none) {
+        native::db_counters total;
+        int64_t ram = 0;
+        for ( auto _: state ) {
+            state.PauseTiming();
+            before();
+            t.chain.reset_counters();
+            int64_t start = t.chain.total_ram();
+            state.ResumeTiming();
+
+            action();
+
+            state.PauseTiming();
+            ram += t.chain.total_ram() - start;
+            const auto& c = t.chain.counters();
+            total.reads += c.reads;
+            total.writes += c.writes;
+            total.erases += c.erases;
+            total.bytes_read += c.bytes_read;
+            total.bytes_written += c.bytes_written;
+            after();
+            state.ResumeTiming();
+        }
+        auto avg = benchmark::Counter::kAvgIterations;
+        state.counters["reads"] = benchmark::Counter( total.reads, avg );
+        state.counters["writes"] = benchmark::Counter( total.writes, avg );
+        state.counters["erases"] = benchmark::Counter( total.erases, avg );
+        state.counters["bytes_read"] = benchmark::Counter( total.bytes_read, avg );
+        state.counters["bytes_written"] = benchmark::Counter( total.bytes_written, avg );
+        state.counters["ram"] = benchmark::Counter( ram, avg );
+        auto usage = t.chain.usage( tester::contract, "nft"_n );
+        state.counters["nft_bytes_per_row"] = usage.rows ? double( usage.billed_bytes ) / usage.rows : 0;
+    }
+
+    void bm_issue(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        measure( state, t, [&]() { t.issue( alice, category, token_name, 1 ); } );
+    }
+
+    void bm_transfernft(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        auto ids = first_owned( t, alice );
+        std::vector<name> owners( ids.size(), alice );
+        size_t i = 0;
+        measure( state, t, [&]() {
+            auto k = i++ % ids.size();
+            auto to = owners[k] == alice ? bob : alice;
+            t.transfernft( owners[k], to, { ids[k] } );
+            owners[k] = to;
+        });
+        for ( size_t k = 0; k < ids.size(); k++ ) {
+            if ( owners[k] != alice ) t.transfernft( owners[k], alice, { ids[k] } );
+        }
+    }
+
+    void bm_listsalenft(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        auto ids = first_owned( t, alice );
+        size_t i = 0;
+        uint64_t id = 0;
+        measure( state, t,
+                 [&]() { t.listsale( alice, { id }, 10000 ); },
+                 [&]() { id = ids[i++ % ids.size()]; },
+                 [&]() { t.push( tester::contract, "closesalenft"_n, { alice }, alice, id ); } );
+    }
+
+    void bm_buynft(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        auto ids = first_owned( t, alice );
+        size_t i = 0;
+        uint64_t id = 0;
+        measure( state, t,
+                 [&]() { t.buy( bob, id, 10000 ); },
+                 [&]() {
+                     id = ids[i++ % ids.size()];
+                     t.listsale( alice, { id }, 10000 );
+                 },
+                 [&]() { t.transfernft( bob, alice, { id } ); } );
+    }
+
+    void bm_burnnft(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        std::vector<uint64_t> ids;
+        measure( state, t,
+                 [&]() {
+                     t.burnnft( alice, { ids.back() } );
+                     ids.pop_back();
+                 },
+                 [&]() {
+                     if ( ids.empty() ) {
+                         t.issue( alice, category, token_name, 100 );
+                         ids = first_owned( t, alice );
+                     }
+                 } );
+    }
+
+    // the memo of every purchase, parsed in the notification of the EOS transfer
+    void bm_parsememo(benchmark::State& state, const char* memo) {
+        for ( auto _: state ) {
+            benchmark::DoNotOptimize( parsememo( memo ) );
+        }
+    }
+
+    void bm_getowned(benchmark::State& state, uint64_t size) {
+        auto& t = chain_with( size );
+        measure( state, t, [&]() {
+            benchmark::DoNotOptimize( t.query<dgoods::ownedpage>( "getowned"_n, alice, std::optional<dgoods::ownedcursor>(), uint32_t( 100 ) ) );
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    uint64_t max_size = 100000;
+    if ( const char* env = std::getenv( "DGOODS_BENCH_MAX" ) ) {
+        max_size = std::stoull( env );
+    }
+    benchmark::RegisterBenchmark( "parsememo/short", bm_parsememo, "0,bob" );
+    benchmark::RegisterBenchmark( "parsememo/long", bm_parsememo, " 18446744073709551615 , abcdefghijkl " );
+    for ( uint64_t size = 1000; size <= max_size; size *= 10 ) {
+        auto suffix = "/" + std::to_string( size );
+        benchmark::RegisterBenchmark( ( "issue" + suffix ).c_str(), bm_issue, size );
+        benchmark::RegisterBenchmark( ( "transfernft" + suffix ).c_str(), bm_transfernft, size );
+        benchmark::RegisterBenchmark( ( "listsalenft" + suffix ).c_str(), bm_listsalenft, size );
+        benchmark::RegisterBenchmark( ( "buynft" + suffix ).c_str(), bm_buynft, size );
+        benchmark::RegisterBenchmark( ( "burnnft" + suffix ).c_str(), bm_burnnft, size );
+        benchmark::RegisterBenchmark( ( "getowned" + suffix ).c_str(), bm_getowned, size );
+    }
+    benchmark::Initialize( &argc, argv );
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,136 @@
+// decoding and exporting a synthetic row dump of DGOODS_DECODER_ROWS dgood and accounts rows, 10M
+// by default, against unpacking every row into the contract's own structs. A dump of 10M dgood
+// rows is some 800 MB, written once to the temp directory and removed at exit.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+#include <decoder.hpp>
+#include <dgoods.hpp>
+
+namespace {
+
+    using namespace decoder;
+
+    const name owners[] = { "alice"_n, "bob"_n, "carol"_n, "dave"_n };
+
+    std::string temp_file(const std::string& name) {
+        const char* dir = std::getenv( "TMPDIR" );
+        return std::string( dir ? dir : "/tmp" ) + "/dgoods_bench_" + std::to_string( ::getpid() ) + "_" + name;
+    }
+
+    // one in four tokens has a relative_uri
+    std::string write_dgood(uint64_t rows) {
+        auto path = temp_file( "dgood.dump" );
+        dump_writer writer( path, "dgood" );
+        std::mt19937_64 random( 1 );
+        for ( uint64_t id = 0; id < rows; id++ ) {
+            dgoods::dgood token;
+            token.id = id;
+            token.serial_number = id / 64 + 1;
+            token.owner = owners[random() % 4];
+            token.category = "tickets"_n;
+            token.token_name = "gold"_n;
+            if ( random() % 4 == 0 ) token.relative_uri = "ipfs/Qm" + std::to_string( random() );
+            writer.add( "dgoods"_n.value, pack( token ) );
+        }
+        writer.close();
+        return path;
+    }
+
+    std::string write_accounts(uint64_t rows) {
+        auto path = temp_file( "accounts.dump" );
+        dump_writer writer( path, "accounts" );
+        std::mt19937_64 random( 2 );
+        for ( uint64_t i = 0; i < rows; i++ ) {
+            dgoods::accounts account{ i % 100, "tickets"_n, "gold"_n, asset( random() % 1000, symbol( "DGOODS", 0 ) ) };
+            writer.add( random(), pack( account ) );
+        }
+        writer.close();
+        return path;
+    }
+
+    struct dumps {
+        std::string dgood;
+        std::string accounts;
+
+        ~dumps() {
+            std::remove( dgood.c_str() );
+            std::remove( accounts.c_str() );
+        }
+    };
+
+    // per row: unpack into dgoods::dgood, allocating its relative_uri
+    void bm_unpack_dgood(benchmark::State& state, const std::string* path) {
+        dump d( *path );
+        for ( auto _: state ) {
+            uint64_t with_uri = 0;
+            for ( uint64_t i = 0; i < d.size(); i++ ) {
+                auto row = d.row( i );
+                auto token = unpack<dgoods::dgood>( row.data(), row.size() );
+                with_uri += token.relative_uri.has_value();
+            }
+            benchmark::DoNotOptimize( with_uri );
+        }
+        state.counters["rows"] = benchmark::Counter( d.size(), benchmark::Counter::kIsIterationInvariantRate );
+    }
+
+    template<typename Row>
+    void bm_scan(benchmark::State& state, const std::string* path) {
+        dump d( *path );
+        unsigned threads = state.range( 0 );
+        for ( auto _: state ) {
+            scan<Row>( d, threads, [&]( uint64_t, const Row& row ) {
+                benchmark::DoNotOptimize( row );
+            });
+        }
+        state.counters["rows"] = benchmark::Counter( d.size(), benchmark::Counter::kIsIterationInvariantRate );
+    }
+
+    template<typename Row>
+    void bm_export(benchmark::State& state, const std::string* path) {
+        dump d( *path );
+        auto out = temp_file( std::string( Row::table ) + ".columns" );
+        uint64_t bytes = 0;
+        for ( auto _: state ) {
+            bytes = export_columns<Row>( d, out, state.range( 0 ) ).bytes;
+        }
+        std::remove( out.c_str() );
+        state.counters["rows"] = benchmark::Counter( d.size(), benchmark::Counter::kIsIterationInvariantRate );
+        state.counters["file_bytes"] = bytes;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    uint64_t rows = 10000000;
+    if ( const char* env = std::getenv( "DGOODS_DECODER_ROWS" ) ) {
+        rows = std::stoull( env );
+    }
+    benchmark::Initialize( &argc, argv );
+    dumps d{ write_dgood( rows ), write_accounts( rows ) };
+
+    // scans and exports run on 1, 2, 4... threads up to the number of cores
+    unsigned cores = std::max( 1u, std::thread::hardware_concurrency() );
+    auto threads = [&]( benchmark::internal::Benchmark* b ) {
+        for ( unsigned t = 1; t < cores; t *= 2 ) {
+            b->Arg( t );
+        }
+        b->Arg( cores )->Unit( benchmark::kMillisecond );
+    };
+    auto suffix = "/" + std::to_string( rows );
+    benchmark::RegisterBenchmark( ( "unpack/dgood" + suffix ).c_str(), bm_unpack_dgood, &d.dgood )
+        ->Unit( benchmark::kMillisecond );
+    threads( benchmark::RegisterBenchmark( ( "scan/dgood" + suffix ).c_str(), bm_scan<dgood_row>, &d.dgood ) );
+    threads( benchmark::RegisterBenchmark( ( "scan/accounts" + suffix ).c_str(), bm_scan<accounts_row>, &d.accounts ) );
+    threads( benchmark::RegisterBenchmark( ( "export/dgood" + suffix ).c_str(), bm_export<dgood_row>, &d.dgood ) );
+    threads( benchmark::RegisterBenchmark( ( "export/accounts" + suffix ).c_str(), bm_export<accounts_row>, &d.accounts ) );
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
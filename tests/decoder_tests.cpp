@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <unistd.h>
+
+#include <decoder.hpp>
+#include <dgoods.hpp>
+
+namespace {
+
+    using namespace decoder;
+
+    constexpr name alice = "alice"_n;
+    constexpr name category = "tickets"_n;
+    constexpr name token_name = "gold"_n;
+
+    // a file removed at the end of the test
+    struct temp_path {
+        std::string path;
+
+        explicit temp_path(const std::string& suffix)
+            : path( ::testing::TempDir() + "dgoods_" + std::to_string( ::getpid() ) + "_" + suffix ) {}
+        ~temp_path() { std::remove( path.c_str() ); }
+    };
+
+    // strings and vectors of the row point into bytes
+    template<typename Row, typename T>
+    Row decoded(const T& row, std::vector<char>& bytes) {
+        bytes = pack( row );
+        return Row::decode( bytes.data(), bytes.size() );
+    }
+
+    dgoods::dgood v1_token(uint64_t id) {
+        dgoods::dgood token;
+        token.id = id;
+        token.serial_number = id + 1;
+        token.owner = alice;
+        token.category = category;
+        token.token_name = token_name;
+        return token;
+    }
+
+    TEST( decoder, decodes_dgood_with_and_without_uri ) {
+        std::vector<char> bytes;
+        auto token = v1_token( 7 );
+        auto row = decoded<dgood_row>( token, bytes );
+        EXPECT_EQ( row.id, 7u );
+        EXPECT_EQ( row.serial_number, 8u );
+        EXPECT_EQ( row.owner, alice.value );
+        EXPECT_EQ( row.token_name, token_name.value );
+        EXPECT_FALSE( row.relative_uri );
+
+        token.relative_uri = string( "a/b" );
+        row = decoded<dgood_row>( token, bytes );
+        EXPECT_EQ( row.relative_uri, std::optional<std::string_view>( "a/b" ) );
+    }
+
+    TEST( decoder, decodes_the_other_tables ) {
+        std::vector<char> bytes;
+        dgoods::accounts balance{ 4, category, token_name, asset( 25, symbol( "DGOODS", 2 ) ) };
+        auto account = decoded<accounts_row>( balance, bytes );
+        EXPECT_EQ( account.category_name_id, 4u );
+        EXPECT_EQ( account.amount.amount, 25 );
+        EXPECT_EQ( account.amount.symbol, symbol( "DGOODS", 2 ).raw() );
+
+        dgoods::dgoodstats stats{};
+        stats.burnable = true;
+        stats.issuer = alice;
+        stats.max_supply = asset( 1000, symbol( "DGOODS", 0 ) );
+        stats.rev_split = 0.05;
+        stats.base_uri = "https://dgoods.io/";
+        stats.rev_split_bps = 500;
+        auto s = decoded<dgoodstats_row>( stats, bytes );
+        EXPECT_FALSE( s.fungible );
+        EXPECT_TRUE( s.burnable );
+        EXPECT_EQ( s.issuer, alice.value );
+        EXPECT_EQ( s.max_supply.amount, 1000 );
+        EXPECT_EQ( s.rev_split, 0.05 );
+        EXPECT_EQ( s.base_uri, "https://dgoods.io/" );
+        EXPECT_EQ( s.rev_split_bps, std::optional<uint16_t>( 500 ) );
+        EXPECT_FALSE( s.holder_count );
+
+        dgoods::asks ask{ 9, { 1, 2, 3 }, alice, asset( 10000, symbol( "EOS", 4 ) ), time_point_sec( 1600000000 ) };
+        auto a = decoded<asks_row>( ask, bytes );
+        EXPECT_EQ( a.batch_id, 9u );
+        ASSERT_EQ( a.dgood_ids.size(), 3u );
+        EXPECT_EQ( a.dgood_ids[2], 3u );
+        EXPECT_EQ( a.expiration, 1600000000u );
+        EXPECT_FALSE( a.category_name_id );
+
+        dgoods::tokenconfigs config{ "dgoods"_n, "2.0", symbol_code( "DGOODS" ), 5 };
+        config.next_dgood_id = 100;
+        auto c = decoded<tokenconfigs_row>( config, bytes );
+        EXPECT_EQ( c.version, "2.0" );
+        EXPECT_EQ( c.symbol, symbol_code( "DGOODS" ).raw() );
+        EXPECT_EQ( c.next_dgood_id, std::optional<uint64_t>( 100 ) );
+        EXPECT_FALSE( c.accrue_proceeds );
+    }
+
+    TEST( decoder, decodes_the_v2_tables ) {
+        std::vector<char> bytes;
+        dgoods::nft token{ 7, 300, alice, 4, 10, 2 };
+        auto t = decoded<nft_row>( token, bytes );
+        EXPECT_EQ( t.id, 7u );
+        EXPECT_EQ( t.serial_number, 300u );
+        EXPECT_EQ( t.owner, alice.value );
+        EXPECT_EQ( t.category_name_id, 4u );
+        EXPECT_EQ( t.lock, 10u );
+        EXPECT_EQ( t.uri_id, 2u );
+
+        dgoods::dgoodranges range{ 1000, 200, 201, alice, 4, 0 };
+        auto r = decoded<dgoodranges_row>( range, bytes );
+        EXPECT_EQ( r.last_id, 1000u );
+        EXPECT_EQ( r.first_id, 200u );
+        EXPECT_EQ( r.serial_number, 201u );
+        EXPECT_EQ( r.owner, alice.value );
+        EXPECT_EQ( r.category_name_id, 4u );
+        EXPECT_EQ( r.uri_id, 0u );
+
+        std::string uri = "a/b";
+        dgoods::uris shared{ 2, uri, dgoods::uri_hash( uri ), 5 };
+        auto u = decoded<uris_row>( shared, bytes );
+        EXPECT_EQ( u.uri_id, 2u );
+        EXPECT_EQ( u.uri, "a/b" );
+        EXPECT_EQ( u.hash, dgoods::uri_hash( uri ) );
+        EXPECT_EQ( u.refs, 5u );
+
+        dgoods::balances balance{ 4, 2500 };
+        auto b = decoded<balances_row>( balance, bytes );
+        EXPECT_EQ( b.category_name_id, 4u );
+        EXPECT_EQ( b.amount, 2500 );
+
+        dgoods::tokentypes type{ 4, category, token_name };
+        auto ty = decoded<tokentypes_row>( type, bytes );
+        EXPECT_EQ( ty.category_name_id, 4u );
+        EXPECT_EQ( ty.category, category.value );
+        EXPECT_EQ( ty.token_name, token_name.value );
+
+        dgoods::typestats stats{ 4, true, false, true, true, true, alice, 500, symbol( "DGOODS", 2 ) };
+        auto s = decoded<typestats_row>( stats, bytes );
+        EXPECT_EQ( s.category_name_id, 4u );
+        EXPECT_TRUE( s.fungible );
+        EXPECT_FALSE( s.burnable );
+        EXPECT_TRUE( s.holders_tracked );
+        EXPECT_EQ( s.rev_partner, alice.value );
+        EXPECT_EQ( s.rev_split_bps, 500u );
+        EXPECT_EQ( s.supply_symbol, symbol( "DGOODS", 2 ).raw() );
+
+        dgoods::holders holder{ alice, 75 };
+        auto h = decoded<holders_row>( holder, bytes );
+        EXPECT_EQ( h.owner, alice.value );
+        EXPECT_EQ( h.amount, 75 );
+    }
+
+    TEST( decoder, short_row_fails ) {
+        auto bytes = pack( v1_token( 1 ) );
+        EXPECT_THROW( dgood_row::decode( bytes.data(), 20 ), decode_error );
+        auto account = pack( dgoods::accounts{ 4, category, token_name, asset( 25, symbol( "DGOODS", 2 ) ) } );
+        EXPECT_THROW( accounts_row::decode( account.data(), account.size() - 1 ), decode_error );
+        auto token = pack( dgoods::nft{ 7, 300, alice, 4, 0, 0 } );
+        EXPECT_THROW( nft_row::decode( token.data(), token.size() - 1 ), decode_error );
+    }
+
+    TEST( decoder, parallel_scan_visits_every_row_once ) {
+        temp_path path( "scan.dump" );
+        dump_writer writer( path.path, "dgood" );
+        for ( uint64_t id = 0; id < 1000; id++ ) {
+            writer.add( alice.value, pack( v1_token( id ) ) );
+        }
+        writer.close();
+
+        dump d( path.path );
+        ASSERT_EQ( d.size(), 1000u );
+        std::vector<int> seen( 1000 );
+        scan<dgood_row>( d, 4, [&]( uint64_t scope, const dgood_row& row ) {
+            EXPECT_EQ( scope, alice.value );
+            seen[row.id]++;
+        });
+        EXPECT_EQ( std::count( seen.begin(), seen.end(), 1 ), 1000 );
+        EXPECT_THROW( scan<asks_row>( d, 1, []( uint64_t, const asks_row& ) {} ), decode_error );
+    }
+
+    TEST( decoder, exported_columns_match_rows ) {
+        temp_path dump_path( "export.dump" );
+        temp_path columns_path( "export.columns" );
+        dump_writer writer( dump_path.path, "dgood" );
+        for ( uint64_t id = 0; id < 100; id++ ) {
+            auto token = v1_token( id );
+            if ( id % 3 == 0 ) token.relative_uri = std::to_string( id );
+            writer.add( id, pack( token ) );
+        }
+        writer.close();
+
+        auto stats = export_columns<dgood_row>( dump( dump_path.path ), columns_path.path, 3 );
+        EXPECT_EQ( stats.rows, 100u );
+
+        column_file columns( columns_path.path );
+        EXPECT_EQ( columns.table(), "dgood" );
+        ASSERT_EQ( columns.rows(), 100u );
+        auto scope = columns.column<uint64_t>( "scope" );
+        auto id = columns.column<uint64_t>( "id" );
+        auto has_uri = columns.column<uint8_t>( "has_relative_uri" );
+        for ( uint64_t i = 0; i < 100; i++ ) {
+            EXPECT_EQ( scope[i], i );
+            EXPECT_EQ( id[i], i );
+            EXPECT_EQ( has_uri[i], i % 3 == 0 );
+            EXPECT_EQ( columns.string( "relative_uri", i ), i % 3 == 0 ? std::to_string( i ) : "" );
+        }
+        EXPECT_THROW( columns.column<uint32_t>( "id" ), decode_error );
+    }
+
+    TEST( decoder, exported_varuints_are_u32_columns ) {
+        temp_path dump_path( "nft.dump" );
+        temp_path columns_path( "nft.columns" );
+        dump_writer writer( dump_path.path, "nft" );
+        for ( uint64_t id = 0; id < 100; id++ ) {
+            // serials of 1 to 3 varuint bytes
+            dgoods::nft token{ id, uint32_t( id * id * id ), alice, 4, uint32_t( id % 5 ), uint32_t( id % 2 ) };
+            writer.add( "dgoods"_n.value, pack( token ) );
+        }
+        writer.close();
+
+        export_columns<nft_row>( dump( dump_path.path ), columns_path.path, 3 );
+
+        column_file columns( columns_path.path );
+        EXPECT_EQ( columns.table(), "nft" );
+        ASSERT_EQ( columns.rows(), 100u );
+        auto id = columns.column<uint64_t>( "id" );
+        auto serial = columns.column<uint32_t>( "serial_number" );
+        auto lock = columns.column<uint32_t>( "lock" );
+        auto uri_id = columns.column<uint32_t>( "uri_id" );
+        for ( uint64_t i = 0; i < 100; i++ ) {
+            EXPECT_EQ( id[i], i );
+            EXPECT_EQ( serial[i], i * i * i );
+            EXPECT_EQ( lock[i], i % 5 );
+            EXPECT_EQ( uri_id[i], i % 2 );
+        }
+        EXPECT_THROW( columns.column<uint64_t>( "lock" ), decode_error );
+    }
+
+    TEST( decoder, exported_lists_keep_their_rows ) {
+        temp_path dump_path( "asks.dump" );
+        temp_path columns_path( "asks.columns" );
+        dump_writer writer( dump_path.path, "asks" );
+        for ( uint64_t batch = 0; batch < 10; batch++ ) {
+            dgoods::asks ask{ batch, std::vector<uint64_t>( batch, batch ), alice, asset( 1, symbol( "EOS", 4 ) ),
+                              time_point_sec( 0 ) };
+            writer.add( "dgoods"_n.value, pack( ask ) );
+        }
+        writer.close();
+
+        export_columns<asks_row>( dump( dump_path.path ), columns_path.path, 4 );
+
+        column_file columns( columns_path.path );
+        auto offsets = columns.column<uint64_t>( "dgood_ids" );
+        auto ids = columns.column<uint64_t>( "dgood_ids.data" );
+        for ( uint64_t batch = 0; batch < 10; batch++ ) {
+            ASSERT_EQ( offsets[batch + 1] - offsets[batch], batch );
+            for ( uint64_t k = offsets[batch]; k < offsets[batch + 1]; k++ ) {
+                EXPECT_EQ( ids[k], batch );
+            }
+        }
+    }
+
+}
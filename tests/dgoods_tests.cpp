@@ -0,0 +1,557 @@
+#include <gtest/gtest.h>
+
+#include "tester.hpp"
+
+namespace {
+
+    constexpr name category = "tickets"_n;
+    constexpr name token_name = "gold"_n;
+    constexpr name alice = "alice"_n;
+    constexpr name bob = "bob"_n;
+    constexpr name carol = "carol"_n;
+
+    class dgoods_test : public ::testing::Test {
+        protected:
+            tester t;
+
+            // ids of the tokens alice holds, in id order
+            std::vector<uint64_t> owned(name owner) {
+                std::vector<uint64_t> ids;
+                for ( const auto& token: t.rows<dgoods::nft>( "nft"_n, tester::contract.value ) ) {
+                    if ( token.owner == owner ) ids.push_back( token.id );
+                }
+                return ids;
+            }
+    };
+
+    TEST_F( dgoods_test, issue_writes_tokens_and_balance ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 3, "a" );
+
+        auto ids = owned( alice );
+        ASSERT_EQ( ids.size(), 3u );
+        auto token = *t.nft( ids[0] );
+        EXPECT_EQ( token.serial_number.value, 1u );
+        EXPECT_EQ( token.lock.value, 0u );
+        EXPECT_EQ( t.balance( alice, 0 ), 3 );
+        EXPECT_EQ( t.stats( category, token_name ).current_supply.amount, 3 );
+        EXPECT_EQ( t.rows<dgoods::uris>( "uris"_n, tester::contract.value ).at( 0 ).refs, 3u );
+    }
+
+    TEST_F( dgoods_test, issue_is_limited_per_call ) {
+        t.create( category, token_name, false, 1000 );
+
+        EXPECT_EQ( t.error( tester::contract, "issue"_n, { tester::issuer }, alice, category, token_name, tester::units( 101 ),
+                            string(), string() ),
+                   "can issue up to 100 at a time" );
+        t.issue( alice, category, token_name, 100 );
+        EXPECT_EQ( t.balance( alice, 0 ), 100 );
+    }
+
+    TEST_F( dgoods_test, transfer_moves_owner_and_balance ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 2 );
+        auto ids = owned( alice );
+
+        t.transfernft( alice, bob, { ids[1] } );
+
+        EXPECT_EQ( t.nft( ids[1] )->owner, bob );
+        EXPECT_EQ( t.balance( alice, 0 ), 1 );
+        EXPECT_EQ( t.balance( bob, 0 ), 1 );
+    }
+
+    TEST_F( dgoods_test, failed_action_reverts_rows_and_ram ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        auto ram = t.chain.ram_usage( tester::contract );
+
+        EXPECT_EQ( t.error( tester::contract, "transfernft"_n, { bob }, bob, carol, std::vector<uint64_t>{ id }, string() ),
+                   "must be token owner" );
+
+        EXPECT_EQ( t.nft( id )->owner, alice );
+        EXPECT_EQ( t.balance( carol, 0 ), 0 );
+        EXPECT_EQ( t.chain.ram_usage( tester::contract ), ram );
+    }
+
+    TEST_F( dgoods_test, sale_pays_seller_and_partner ) {
+        t.create( category, token_name, false, 1000, 0.1 );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        t.fund( bob, 100000 );
+
+        t.listsale( alice, { id }, 10000 );
+        EXPECT_EQ( t.nft( id )->lock.value, 1u );
+        t.buy( bob, id, 10000 );
+
+        EXPECT_EQ( t.nft( id )->owner, bob );
+        EXPECT_EQ( t.nft( id )->lock.value, 0u );
+        EXPECT_EQ( t.eos_balance( alice ), 9000 );
+        EXPECT_EQ( t.eos_balance( tester::partner ), 1000 );
+        EXPECT_EQ( t.eos_balance( bob ), 90000 );
+        EXPECT_TRUE( t.rows<dgoods::asks>( "asks"_n, tester::contract.value ).empty() );
+    }
+
+    TEST_F( dgoods_test, listed_token_cannot_move ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        t.listsale( alice, { id }, 10000 );
+
+        EXPECT_EQ( t.error( tester::contract, "transfernft"_n, { alice }, alice, bob, std::vector<uint64_t>{ id }, string() ),
+                   "token locked, cannot transfer" );
+    }
+
+    TEST_F( dgoods_test, range_is_materialized_on_first_use ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10 );
+        EXPECT_TRUE( owned( alice ).empty() );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+
+        t.transfernft( alice, bob, { range.first_id + 4 } );
+
+        EXPECT_EQ( t.nft( range.first_id + 4 )->owner, bob );
+        EXPECT_EQ( t.nft( range.first_id + 4 )->serial_number.value, 5u );
+        EXPECT_EQ( t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).size(), 2u );
+        EXPECT_EQ( t.balance( alice, 0 ), 9 );
+        EXPECT_EQ( t.balance( bob, 0 ), 1 );
+    }
+
+    TEST_F( dgoods_test, listing_keeps_issuer_billed_row_size ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 100 );
+        t.issue( alice, category, token_name, 100 );
+        auto id = owned( alice ).back();
+        ASSERT_GE( id, 128u );
+        auto issuer_ram = t.chain.ram_usage( tester::issuer );
+
+        // the issuer pays for the row and does not sign the listing
+        t.listsale( alice, { id }, 10000 );
+
+        EXPECT_TRUE( t.nft( id )->lock.value != 0 );
+        EXPECT_EQ( t.chain.ram_usage( tester::issuer ), issuer_ram );
+    }
+
+    TEST_F( dgoods_test, serial_numbers_fit_in_varuint32 ) {
+        t.create( category, token_name, false, 10000000000 );
+
+        EXPECT_EQ( t.error( tester::contract, "issuerange"_n, { tester::issuer }, alice, category, token_name,
+                            tester::units( dgoods::MAX_TOKEN_NUMBER + 1 ), string(), string() ),
+                   "no serial_number left" );
+        t.issuerange( alice, category, token_name, dgoods::MAX_TOKEN_NUMBER );
+        EXPECT_EQ( t.error( tester::contract, "issue"_n, { tester::issuer }, alice, category, token_name, tester::units( 1 ),
+                            string(), string() ),
+                   "no serial_number left" );
+    }
+
+    TEST_F( dgoods_test, transfer_from_range_bills_sender ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+        // creates the nft table
+        t.transfernft( alice, bob, { range.first_id } );
+        auto alice_ram = t.chain.ram_usage( alice );
+        auto issuer_ram = t.chain.ram_usage( tester::issuer );
+
+        t.transfernft( alice, bob, { range.first_id + 4 } );
+
+        // the token row and the range of the ids before it
+        EXPECT_GT( t.chain.ram_usage( alice ) - alice_ram, 800 );
+        EXPECT_EQ( t.chain.ram_usage( tester::issuer ), issuer_ram );
+        EXPECT_EQ( t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).size(), 2u );
+    }
+
+    TEST_F( dgoods_test, burntype_returns_serial_past_locked_tokens ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 5 );
+        auto ids = owned( alice );
+        t.listsale( alice, { ids[0] }, 10000 );
+        t.listsale( alice, { ids[1] }, 10000 );
+
+        EXPECT_EQ( t.burntype( category, token_name, 0, 3 ), std::optional<uint64_t>( 4 ) );
+        EXPECT_EQ( t.balance( alice, 0 ), 4 );
+        EXPECT_EQ( t.burntype( category, token_name, 4, 3 ), std::nullopt );
+        EXPECT_EQ( owned( alice ), std::vector<uint64_t>( { ids[0], ids[1] } ) );
+        EXPECT_EQ( t.balance( alice, 0 ), 2 );
+        EXPECT_EQ( t.stats( category, token_name ).current_supply.amount, 2 );
+    }
+
+    TEST_F( dgoods_test, burntype_splits_range_straddling_from_serial ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+
+        EXPECT_EQ( t.burntype( category, token_name, 5, 10 ), std::nullopt );
+
+        auto ranges = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value );
+        ASSERT_EQ( ranges.size(), 1u );
+        EXPECT_EQ( ranges[0].first_id, range.first_id );
+        EXPECT_EQ( ranges[0].last_id, range.first_id + 3 );
+        EXPECT_EQ( ranges[0].serial_number.value, 1u );
+        EXPECT_EQ( t.balance( alice, 0 ), 4 );
+        EXPECT_EQ( t.stats( category, token_name ).current_supply.amount, 4 );
+        t.transfernft( alice, bob, { range.first_id + 3 } );
+        EXPECT_EQ( t.nft( range.first_id + 3 )->serial_number.value, 4u );
+    }
+
+    TEST_F( dgoods_test, seturis_splits_range_straddling_from_serial ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10, "a" );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+
+        EXPECT_EQ( t.seturis( category, token_name, "b", 5, 10 ), std::nullopt );
+
+        auto ranges = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value );
+        ASSERT_EQ( ranges.size(), 2u );
+        auto uris = t.rows<dgoods::uris>( "uris"_n, tester::contract.value );
+        ASSERT_EQ( uris.size(), 2u );
+        EXPECT_EQ( ranges[0].last_id, range.first_id + 3 );
+        EXPECT_EQ( ranges[0].uri_id.value, uris[0].uri_id );
+        EXPECT_EQ( ranges[1].first_id, range.first_id + 4 );
+        EXPECT_EQ( ranges[1].serial_number.value, 5u );
+        EXPECT_EQ( ranges[1].uri_id.value, uris[1].uri_id );
+        EXPECT_EQ( uris[0].uri, "a" );
+        EXPECT_EQ( uris[0].refs, 1u );
+        EXPECT_EQ( uris[1].uri, "b" );
+        EXPECT_EQ( uris[1].refs, 1u );
+        t.transfernft( alice, bob, { range.first_id + 3, range.first_id + 4 } );
+        EXPECT_EQ( t.nft( range.first_id + 3 )->uri_id.value, uris[0].uri_id );
+        EXPECT_EQ( t.nft( range.first_id + 4 )->uri_id.value, uris[1].uri_id );
+    }
+
+    TEST_F( dgoods_test, seturis_resumes_across_tokens_and_ranges ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 5, "a" );
+        t.issuerange( alice, category, token_name, 5, "a" );
+
+        EXPECT_EQ( t.seturis( category, token_name, "b", 1, 3 ), std::optional<uint64_t>( 4 ) );
+        auto uris = t.rows<dgoods::uris>( "uris"_n, tester::contract.value );
+        ASSERT_EQ( uris.size(), 2u );
+        EXPECT_EQ( uris[0].refs, 3u );
+        EXPECT_EQ( uris[1].refs, 3u );
+
+        EXPECT_EQ( t.seturis( category, token_name, "b", 4, 3 ), std::nullopt );
+        uris = t.rows<dgoods::uris>( "uris"_n, tester::contract.value );
+        ASSERT_EQ( uris.size(), 1u );
+        EXPECT_EQ( uris[0].uri, "b" );
+        // five tokens and the range
+        EXPECT_EQ( uris[0].refs, 6u );
+        for ( const auto& token: t.rows<dgoods::nft>( "nft"_n, tester::contract.value ) ) {
+            EXPECT_EQ( token.uri_id.value, uris[0].uri_id );
+        }
+        EXPECT_EQ( t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 ).uri_id.value,
+                   uris[0].uri_id );
+    }
+
+    TEST_F( dgoods_test, trackholders_without_supply_is_complete ) {
+        t.create( category, token_name, false, 1000 );
+        t.push( tester::contract, "trackholders"_n, { tester::issuer }, category, token_name );
+        EXPECT_FALSE( t.find<dgoods::holderfill>( "holderfill"_n, tester::contract.value, 0 ) );
+
+        t.issue( alice, category, token_name, 2 );
+
+        EXPECT_EQ( t.stats( category, token_name ).holder_count.value(), 1u );
+        EXPECT_EQ( t.find<dgoods::holders>( "holders"_n, 0, alice.value )->amount, 2 );
+        EXPECT_EQ( t.error( tester::contract, "addholders"_n, { tester::issuer }, category, token_name,
+                            std::vector<name>{ alice } ),
+                   "holders already complete" );
+
+        // bob's holder row is paid by the contract, like his balance row
+        auto issuer_ram = t.chain.ram_usage( tester::issuer );
+        auto contract_ram = t.chain.ram_usage( tester::contract );
+        t.transfernft( alice, bob, { owned( alice ).at( 0 ) } );
+        EXPECT_TRUE( t.find<dgoods::holders>( "holders"_n, 0, bob.value ) );
+        EXPECT_EQ( t.chain.ram_usage( tester::issuer ), issuer_ram );
+        EXPECT_GT( t.chain.ram_usage( tester::contract ), contract_ram );
+    }
+
+    TEST_F( dgoods_test, addholders_backfills_holders_from_before_tracking ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 3 );
+        t.issue( bob, category, token_name, 2 );
+        t.push( tester::contract, "trackholders"_n, { tester::issuer }, category, token_name );
+        // holders touched while the backfill runs are tracked right away
+        t.transfernft( alice, carol, { owned( alice ).at( 0 ) } );
+        EXPECT_EQ( t.stats( category, token_name ).holder_count.value(), 2u );
+
+        t.push( tester::contract, "addholders"_n, { tester::issuer }, category, token_name, std::vector<name>{ alice } );
+        EXPECT_EQ( t.find<dgoods::holderfill>( "holderfill"_n, tester::contract.value, 0 )->held, 3 );
+        t.push( tester::contract, "addholders"_n, { tester::issuer }, category, token_name,
+                std::vector<name>{ bob, "dave"_n } );
+
+        EXPECT_FALSE( t.find<dgoods::holderfill>( "holderfill"_n, tester::contract.value, 0 ) );
+        EXPECT_EQ( t.stats( category, token_name ).holder_count.value(), 3u );
+        EXPECT_EQ( t.find<dgoods::holders>( "holders"_n, 0, bob.value )->amount, 2 );
+        EXPECT_FALSE( t.find<dgoods::holders>( "holders"_n, 0, "dave"_n.value ) );
+    }
+
+    TEST_F( dgoods_test, sale_with_full_rev_split_pays_only_the_partner ) {
+        t.create( category, token_name, false, 1000, 1.0 );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        t.listsale( alice, { id }, 10000 );
+        t.fund( bob, 10000 );
+
+        t.buy( bob, id, 10000 );
+
+        EXPECT_EQ( t.nft( id )->owner, bob );
+        EXPECT_EQ( t.eos_balance( tester::partner ), 10000 );
+        EXPECT_EQ( t.eos_balance( alice ), 0 );
+    }
+
+    TEST_F( dgoods_test, accrued_sale_with_full_rev_split_owes_the_seller_nothing ) {
+        t.create( category, token_name, false, 1000, 1.0 );
+        t.push( tester::contract, "setaccrual"_n, { tester::contract }, true );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        t.listsale( alice, { id }, 10000 );
+        t.fund( bob, 10000 );
+
+        t.buy( bob, id, 10000 );
+
+        auto owed = t.rows<dgoods::proceeds>( "proceeds"_n, tester::contract.value );
+        ASSERT_EQ( owed.size(), 1u );
+        EXPECT_EQ( owed[0].account, tester::partner );
+        EXPECT_EQ( t.error( tester::contract, "withdraw"_n, { alice }, alice ), "no proceeds to withdraw" );
+        t.push( tester::contract, "settle"_n, {}, name(), uint64_t( 10 ) );
+        EXPECT_EQ( t.eos_balance( tester::partner ), 10000 );
+    }
+
+    TEST_F( dgoods_test, settle_erases_proceeds_of_nothing ) {
+        t.push( tester::contract, "setaccrual"_n, { tester::contract }, true );
+        // written before zero payouts were skipped
+        t.store( "proceeds"_n, tester::contract.value, carol.value, dgoods::proceeds{ carol, tester::eos( 0 ) } );
+        t.store( "proceeds"_n, tester::contract.value, tester::partner.value,
+                 dgoods::proceeds{ tester::partner, tester::eos( 500 ) } );
+        t.fund( tester::contract, 500 );
+
+        EXPECT_EQ( t.error( tester::contract, "withdraw"_n, { carol }, carol ), "no proceeds to withdraw" );
+        t.push( tester::contract, "settle"_n, {}, name(), uint64_t( 10 ) );
+
+        EXPECT_TRUE( t.rows<dgoods::proceeds>( "proceeds"_n, tester::contract.value ).empty() );
+        EXPECT_EQ( t.eos_balance( tester::partner ), 500 );
+    }
+
+    TEST_F( dgoods_test, settle_starts_at_from ) {
+        t.push( tester::contract, "setaccrual"_n, { tester::contract }, true );
+        t.store( "proceeds"_n, tester::contract.value, bob.value, dgoods::proceeds{ bob, tester::eos( 300 ) } );
+        t.store( "proceeds"_n, tester::contract.value, carol.value, dgoods::proceeds{ carol, tester::eos( 500 ) } );
+        t.fund( tester::contract, 800 );
+
+        // as if bob's transfer kept failing
+        t.push( tester::contract, "settle"_n, {}, carol, uint64_t( 10 ) );
+
+        auto owed = t.rows<dgoods::proceeds>( "proceeds"_n, tester::contract.value );
+        ASSERT_EQ( owed.size(), 1u );
+        EXPECT_EQ( owed[0].account, bob );
+        EXPECT_EQ( t.eos_balance( carol ), 500 );
+        EXPECT_EQ( t.eos_balance( bob ), 0 );
+    }
+
+    TEST_F( dgoods_test, fungible_transfer ) {
+        t.create( category, token_name, true, 1000000, 0.05, true, true, true, 2 );
+        t.issue( alice, category, token_name, 1000, "", 2 );
+        t.push( tester::contract, "transferft"_n, { alice }, alice, bob, category, token_name, tester::units( 250, 2 ), string() );
+
+        EXPECT_EQ( t.balance( alice, 0 ), 750 );
+        EXPECT_EQ( t.balance( bob, 0 ), 250 );
+    }
+
+    TEST_F( dgoods_test, airdrop_credits_every_recipient ) {
+        t.create( category, token_name, true, 1000000, 0.05, true, true, true, 2 );
+        t.issue( alice, category, token_name, 1000, "", 2 );
+        std::vector<dgoods::ftrecipient> recipients = { { bob, tester::units( 100, 2 ) }, { carol, tester::units( 50, 2 ) },
+                                                        { bob, tester::units( 25, 2 ) } };
+
+        t.push( tester::contract, "airdropft"_n, { alice }, alice, category, token_name, recipients, string() );
+
+        EXPECT_EQ( t.balance( alice, 0 ), 825 );
+        EXPECT_EQ( t.balance( bob, 0 ), 125 );
+        EXPECT_EQ( t.balance( carol, 0 ), 50 );
+    }
+
+    TEST_F( dgoods_test, process_burns_range_split_by_queuejob ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+        auto alice_ram = t.chain.ram_usage( alice );
+        t.push( tester::contract, "queuejob"_n, { alice }, alice, "burnnft"_n, name(), std::vector<uint64_t>(),
+                range.first_id + 3, range.first_id + 5 );
+        // the job row and the two heads split off at its bounds
+        EXPECT_GT( t.chain.ram_usage( alice ), alice_ram );
+        EXPECT_EQ( t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).size(), 3u );
+        auto contract_ram = t.chain.ram_usage( tester::contract );
+        alice_ram = t.chain.ram_usage( alice );
+
+        // one step burns the range in the job's bounds
+        t.push( tester::contract, "process"_n, {}, uint64_t( 0 ), uint64_t( 1 ) );
+
+        EXPECT_TRUE( t.rows<dgoods::jobs>( "jobs"_n, tester::contract.value ).empty() );
+        EXPECT_EQ( t.balance( alice, 0 ), 7 );
+        auto ranges = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value );
+        ASSERT_EQ( ranges.size(), 2u );
+        EXPECT_EQ( ranges[0].last_id, range.first_id + 2 );
+        EXPECT_EQ( ranges[1].first_id, range.first_id + 6 );
+        EXPECT_EQ( ranges[1].serial_number.value, 7u );
+        EXPECT_TRUE( t.rows<dgoods::nft>( "nft"_n, tester::contract.value ).empty() );
+        EXPECT_LE( t.chain.ram_usage( tester::contract ), contract_ram );
+        EXPECT_LT( t.chain.ram_usage( alice ), alice_ram );
+    }
+
+    TEST_F( dgoods_test, process_moves_whole_ranges ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 1 );
+        t.issuerange( alice, category, token_name, 401 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+        auto id = owned( alice ).at( 0 );
+        t.push( tester::contract, "queuejob"_n, { alice }, alice, "transfernft"_n, bob, std::vector<uint64_t>(),
+                id, range.last_id );
+        auto contract_ram = t.chain.ram_usage( tester::contract );
+        auto alice_ram = t.chain.ram_usage( alice );
+
+        // the token, then the range
+        t.push( tester::contract, "process"_n, {}, uint64_t( 0 ), uint64_t( 1 ) );
+        EXPECT_EQ( t.nft( id )->owner, bob );
+        t.push( tester::contract, "process"_n, {}, uint64_t( 0 ), uint64_t( 1 ) );
+
+        EXPECT_TRUE( t.rows<dgoods::jobs>( "jobs"_n, tester::contract.value ).empty() );
+        auto ranges = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value );
+        ASSERT_EQ( ranges.size(), 1u );
+        EXPECT_EQ( ranges[0].owner, bob );
+        EXPECT_EQ( t.rows<dgoods::nft>( "nft"_n, tester::contract.value ).size(), 1u );
+        EXPECT_EQ( t.balance( alice, 0 ), 0 );
+        EXPECT_EQ( t.balance( bob, 0 ), 402 );
+        // only bob's balance row, no token row
+        EXPECT_LT( t.chain.ram_usage( tester::contract ) - contract_ram, 300 );
+        EXPECT_LT( t.chain.ram_usage( alice ), alice_ram );
+    }
+
+    TEST_F( dgoods_test, queuejob_rejects_listed_ids_in_a_range ) {
+        t.create( category, token_name, false, 1000 );
+        t.issuerange( alice, category, token_name, 10 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+
+        EXPECT_EQ( t.error( tester::contract, "queuejob"_n, { alice }, alice, "burnnft"_n, name(),
+                            std::vector<uint64_t>{ range.first_id + 3 }, uint64_t( 0 ), uint64_t( 0 ) ),
+                   "dgood_id is in a range, queue an id range instead" );
+    }
+
+    TEST_F( dgoods_test, process_skips_v1_locked_tokens ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 1 );
+        auto id = owned( alice ).at( 0 );
+        dgoods::dgood v1;
+        v1.id = 1000;
+        v1.serial_number = 2;
+        v1.owner = alice;
+        v1.category = category;
+        v1.token_name = token_name;
+        t.store( "dgood"_n, tester::contract.value, v1.id, v1 );
+        t.store( "lockednfts"_n, tester::contract.value, v1.id, dgoods::lockednfts{ v1.id } );
+        t.push( tester::contract, "queuejob"_n, { alice }, alice, "burnnft"_n, name(), std::vector<uint64_t>{ v1.id, id },
+                uint64_t( 0 ), uint64_t( 0 ) );
+
+        t.push( tester::contract, "process"_n, {}, uint64_t( 0 ), uint64_t( 10 ) );
+
+        EXPECT_TRUE( t.rows<dgoods::jobs>( "jobs"_n, tester::contract.value ).empty() );
+        EXPECT_FALSE( t.nft( id ) );
+        EXPECT_TRUE( t.find<dgoods::dgood>( "dgood"_n, tester::contract.value, v1.id ) );
+    }
+
+    TEST_F( dgoods_test, queries_return_pages ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 3 );
+        auto ids = owned( alice );
+        t.listsale( alice, { ids[0] }, 10000 );
+
+        auto page = t.query<dgoods::ownedpage>( "getowned"_n, alice, std::optional<dgoods::ownedcursor>(), uint32_t( 2 ) );
+        ASSERT_EQ( page.tokens.size(), 2u );
+        EXPECT_TRUE( page.tokens[0].locked );
+        EXPECT_EQ( page.tokens[0].uri, "https://dgoods.io/" );
+        ASSERT_TRUE( page.cursor.has_value() );
+        auto next = t.query<dgoods::ownedpage>( "getowned"_n, alice, page.cursor, uint32_t( 2 ) );
+        ASSERT_EQ( next.tokens.size(), 1u );
+        EXPECT_FALSE( next.cursor.has_value() );
+
+        auto balances = t.query<std::vector<dgoods::ownedbalance>>( "getbalances"_n, alice );
+        ASSERT_EQ( balances.size(), 1u );
+        EXPECT_EQ( balances[0].amount.amount, 3 );
+
+        auto asks = t.query<dgoods::askpage>( "getasks"_n, alice, std::optional<uint64_t>(), uint32_t( 10 ) );
+        ASSERT_EQ( asks.asks.size(), 1u );
+        EXPECT_EQ( asks.asks[0].token_name, token_name );
+    }
+
+    TEST_F( dgoods_test, getowned_resumes_range_after_materialized_id ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 2 );
+        t.issuerange( alice, category, token_name, 5 );
+        auto range = t.rows<dgoods::dgoodranges>( "dgoodranges"_n, tester::contract.value ).at( 0 );
+
+        auto page = t.query<dgoods::ownedpage>( "getowned"_n, alice, std::optional<dgoods::ownedcursor>(), uint32_t( 2 ) );
+        ASSERT_EQ( page.tokens.size(), 2u );
+        ASSERT_TRUE( page.cursor.has_value() );
+        EXPECT_EQ( page.cursor->table, "dgoodranges"_n );
+        EXPECT_EQ( page.cursor->id, range.first_id );
+        // listing moves the first id of the range to nft, behind the cursor
+        t.listsale( alice, { range.first_id }, 10000 );
+
+        auto next = t.query<dgoods::ownedpage>( "getowned"_n, alice, page.cursor, uint32_t( 2 ) );
+        ASSERT_EQ( next.tokens.size(), 1u );
+        EXPECT_EQ( next.tokens[0].id, range.first_id + 1 );
+        EXPECT_EQ( next.tokens[0].last_id, range.last_id );
+        EXPECT_FALSE( next.cursor.has_value() );
+    }
+
+    TEST_F( dgoods_test, migrate_keeps_lock_of_v1_row ) {
+        t.create( category, token_name, false, 1000 );
+        dgoods::dgood v1;
+        v1.id = 1000;
+        v1.serial_number = 1;
+        v1.owner = alice;
+        v1.category = category;
+        v1.token_name = token_name;
+        t.store( "dgood"_n, tester::contract.value, v1.id, v1 );
+        t.store( "lockednfts"_n, tester::contract.value, v1.id, dgoods::lockednfts{ v1.id } );
+        t.store( "asks"_n, tester::contract.value, v1.id,
+                 dgoods::asks{ v1.id, { v1.id }, alice, tester::eos( 10000 ), time_point_sec( 1600000000 ) } );
+
+        t.migrate( 100 );
+
+        EXPECT_FALSE( t.find<dgoods::dgood>( "dgood"_n, tester::contract.value, v1.id ) );
+        EXPECT_TRUE( t.rows<dgoods::lockednfts>( "lockednfts"_n, tester::contract.value ).empty() );
+        EXPECT_EQ( t.nft( v1.id )->lock.value, 1u );
+        // the report matches what the chain bills for the nft row
+        auto report = *t.find<dgoods::migrated>( "migrated"_n, tester::contract.value, "dgood"_n.value );
+        EXPECT_EQ( report.rows, 1u );
+        EXPECT_EQ( report.v1_bytes, pack_size( v1 ) + native::row_overhead + native::index_overhead<uint64_t> +
+                                    pack_size( dgoods::lockednfts{ v1.id } ) + native::row_overhead );
+        EXPECT_EQ( report.v2_bytes, t.chain.usage( tester::contract, "nft"_n ).billed_bytes - 2 * native::table_overhead );
+    }
+
+    TEST_F( dgoods_test, migrate_runs_steps_in_order ) {
+        t.create( category, token_name, false, 1000 );
+        auto progress = [&]() { return *t.find<dgoods::migration>( "migration"_n, tester::contract.value, "migration"_n.value ); };
+
+        // empty tables finish their step without using any rows
+        t.migrate( 0 );
+        EXPECT_EQ( progress().table, "dgoodstats"_n );
+        EXPECT_EQ( progress().step, 3u );
+        t.migrate( 100 );
+        EXPECT_EQ( progress().table, "done"_n );
+        EXPECT_EQ( progress().step, dgoods::MIGRATION_STEP_COUNT );
+    }
+
+    TEST_F( dgoods_test, nft_row_billing ) {
+        t.create( category, token_name, false, 1000 );
+        t.issue( alice, category, token_name, 10 );
+
+        auto usage = t.chain.usage( tester::contract, "nft"_n );
+        EXPECT_EQ( usage.rows, 10u );
+        // id and owner, and one byte each for serial_number, category_name_id, lock and uri_id
+        EXPECT_EQ( usage.data_bytes, 10 * 20 );
+        // row overhead plus the byownertype and bytypeserial entries, and the tables holding them
+        EXPECT_EQ( usage.billed_bytes, usage.data_bytes + 10 * ( native::row_overhead + 2 * native::index_overhead<uint128_t> ) +
+                                       2 * native::table_overhead );
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// actions of eosio.cdt: authorization checks, notifications, inline actions, the action data of
+// the running action and its return value
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+#include "native.hpp"
+
+namespace eosio {
+
+    inline void require_auth(name n) { native::chain::current().require_auth( n ); }
+    inline bool has_auth(name n) { return native::chain::current().has_auth( n ); }
+    inline bool is_account(name n) { return native::chain::current().is_account( n ); }
+
+    inline void require_recipient(name notify_account) { native::chain::current().require_recipient( notify_account ); }
+
+    template<typename... accounts>
+    void require_recipient(name notify_account, accounts... remaining_accounts) {
+        require_recipient( notify_account );
+        require_recipient( remaining_accounts... );
+    }
+
+    inline uint32_t action_data_size() { return uint32_t( native::chain::current().current_action().data.size() ); }
+
+    inline uint32_t read_action_data(void* msg, uint32_t len) {
+        const auto& data = native::chain::current().current_action().data;
+        auto size = std::min<size_t>( len, data.size() );
+        memcpy( msg, data.data(), size );
+        return uint32_t( size );
+    }
+
+    template<typename T>
+    T unpack_action_data() {
+        const auto& data = native::chain::current().current_action().data;
+        return unpack<T>( data.data(), data.size() );
+    }
+
+    struct action {
+        eosio::name account;
+        eosio::name name;
+        std::vector<permission_level> authorization;
+        std::vector<char> data;
+
+        action() = default;
+
+        template<typename T>
+        action(const permission_level& auth, struct name a, struct name n, T&& value)
+            : account( a ), name( n ), authorization( 1, auth ), data( pack( std::forward<T>( value ) ) ) {}
+
+        template<typename T>
+        action(std::vector<permission_level> auths, struct name a, struct name n, T&& value)
+            : account( a ), name( n ), authorization( std::move( auths ) ), data( pack( std::forward<T>( value ) ) ) {}
+
+        void send() const {
+            native::chain::current().send_inline( { account, name, authorization, data } );
+        }
+
+        template<typename T>
+        T data_as() const { return unpack<T>( data ); }
+    };
+
+    template<typename, name::raw>
+    struct inline_dispatcher;
+
+    template<typename T, name::raw Name, typename... Args>
+    struct inline_dispatcher<void (T::*)(Args...), Name> {
+        static void call(name code, const permission_level& perm, std::tuple<Args...> args) {
+            action( perm, code, name( Name ), std::move( args ) ).send();
+        }
+
+        static void call(name code, std::vector<permission_level> perms, std::tuple<Args...> args) {
+            action( std::move( perms ), code, name( Name ), std::move( args ) ).send();
+        }
+    };
+}
+
+#define INLINE_ACTION_SENDER( CONTRACT_CLASS, NAME ) \
+    ::eosio::inline_dispatcher<decltype( &CONTRACT_CLASS::NAME ), ::eosio::name::raw( ::eosio::name( #NAME ).value )>::call
+
+#define SEND_INLINE_ACTION( CONTRACT, NAME, ... ) \
+    INLINE_ACTION_SENDER( std::decay_t<decltype( CONTRACT )>, NAME )( ( CONTRACT ).get_self(), __VA_ARGS__ );
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <utility>
+
+#include "check.hpp"
+
+namespace eosio {
+
+    // a trailing field that may be missing from rows written before it existed, it is
+    // only read when bytes are left and only written when it has a value
+    template<typename T>
+    class binary_extension {
+        public:
+            using value_type = T;
+
+            binary_extension() {}
+            binary_extension(const T& ext) : _has_value( true ), _value( ext ) {}
+            binary_extension(T&& ext) : _has_value( true ), _value( std::move( ext ) ) {}
+
+            bool has_value() const { return _has_value; }
+            explicit operator bool() const { return _has_value; }
+
+            T& value() & {
+                check( _has_value, "cannot get value of empty binary_extension" );
+                return _value;
+            }
+
+            const T& value() const & {
+                check( _has_value, "cannot get value of empty binary_extension" );
+                return _value;
+            }
+
+            T value_or(const T& def = T()) const { return _has_value ? _value : def; }
+
+            T& operator*() & { return value(); }
+            const T& operator*() const & { return value(); }
+
+            binary_extension& operator=(const T& ext) {
+                _has_value = true;
+                _value = ext;
+                return *this;
+            }
+
+            template<typename... Args>
+            T& emplace(Args&&... args) {
+                _value = T( std::forward<Args>( args )... );
+                _has_value = true;
+                return _value;
+            }
+
+            void reset() {
+                _value = T();
+                _has_value = false;
+            }
+
+            template<typename DataStream>
+            friend DataStream& operator<<(DataStream& ds, const binary_extension& be) {
+                if ( be._has_value ) {
+                    ds << be._value;
+                }
+                return ds;
+            }
+
+            template<typename DataStream>
+            friend DataStream& operator>>(DataStream& ds, binary_extension& be) {
+                if ( ds.remaining() ) {
+                    T val;
+                    ds >> val;
+                    be.emplace( std::move( val ) );
+                }
+                return ds;
+            }
+
+        private:
+            bool _has_value = false;
+            T _value = T();
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// check and eosio_assert of the native stand-in for eosio.cdt, a failed check throws instead of
+// aborting the wasm so the harness can revert the transaction and report the message
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace eosio {
+
+    struct assertion_failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    inline void check(bool pred, const char* msg) {
+        if ( !pred ) {
+            throw assertion_failure( msg );
+        }
+    }
+
+    inline void check(bool pred, const std::string& msg) {
+        if ( !pred ) {
+            throw assertion_failure( msg );
+        }
+    }
+
+    inline void check(bool pred, std::string_view msg) {
+        if ( !pred ) {
+            throw assertion_failure( std::string( msg ) );
+        }
+    }
+
+    inline void check(bool pred, const char* msg, size_t n) {
+        if ( !pred ) {
+            throw assertion_failure( std::string( msg, n ) );
+        }
+    }
+
+    inline void check(bool pred, uint64_t code) {
+        if ( !pred ) {
+            throw assertion_failure( "assertion failure with error code: " + std::to_string( code ) );
+        }
+    }
+}
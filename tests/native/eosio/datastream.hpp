@@ -0,0 +1,334 @@
+#pragma once
+
+// datastream and the binary serialization of eosio.cdt: little endian integers, varuint32 lengths,
+// structs field by field, through EOSLIB_SERIALIZE or, like cdt, by reflecting plain aggregates
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "varint.hpp"
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
+
+namespace eosio {
+
+    template<typename T>
+    class datastream {
+        public:
+            datastream(T start, size_t s) : _start( start ), _pos( start ), _end( start + s ) {}
+
+            void skip(size_t s) { _pos += s; }
+
+            bool read(char* d, size_t s) {
+                check( size_t( _end - _pos ) >= s, "datastream attempted to read past the end" );
+                memcpy( d, _pos, s );
+                _pos += s;
+                return true;
+            }
+
+            bool write(const char* d, size_t s) {
+                check( _end - _pos >= int32_t( s ), "datastream attempted to write past the end" );
+                memcpy( reinterpret_cast<void*>( _pos ), d, s );
+                _pos += s;
+                return true;
+            }
+
+            bool get(char& c) { return read( &c, 1 ); }
+
+            T pos() const { return _pos; }
+            bool valid() const { return _pos <= _end && _pos >= _start; }
+            bool seekp(size_t p) { _pos = _start + p; return _pos <= _end; }
+            size_t tellp() const { return size_t( _pos - _start ); }
+            size_t remaining() const { return _end - _pos; }
+
+        private:
+            T _start;
+            T _pos;
+            T _end;
+    };
+
+    // counts the bytes written instead of writing them, used by pack_size
+    template<>
+    class datastream<size_t> {
+        public:
+            datastream(size_t init_size = 0) : _size( init_size ) {}
+
+            bool skip(size_t s) { _size += s; return true; }
+            bool write(const char*, size_t s) { _size += s; return true; }
+            bool seekp(size_t p) { _size = p; return true; }
+            size_t tellp() const { return _size; }
+            size_t remaining() const { return 0; }
+
+        private:
+            size_t _size;
+    };
+
+    namespace detail {
+        template<typename T> struct is_optional : std::false_type {};
+        template<typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+        // converts to any field type, used to count the fields of an aggregate
+        struct any_field {
+            template<typename T, typename = std::enable_if_t<!is_optional<T>::value>>
+            operator T() const noexcept;
+        };
+
+        template<typename T, typename Seq, typename = void>
+        struct brace_constructible : std::false_type {};
+
+        template<typename T, size_t... I>
+        struct brace_constructible<T, std::index_sequence<I...>,
+                                   std::void_t<decltype( T{ ( (void)I, any_field{} )... } )>> : std::true_type {};
+
+        template<typename T, size_t N = 0>
+        constexpr size_t field_count() {
+            if constexpr ( brace_constructible<T, std::make_index_sequence<N + 1>>::value ) {
+                return field_count<T, N + 1>();
+            } else {
+                return N;
+            }
+        }
+
+        template<typename T>
+        constexpr bool is_reflected = std::is_aggregate_v<T> && !std::is_array_v<T>;
+
+        #define EOSIO_NATIVE_FIELDS_1 f1
+        #define EOSIO_NATIVE_FIELDS_2 EOSIO_NATIVE_FIELDS_1, f2
+        #define EOSIO_NATIVE_FIELDS_3 EOSIO_NATIVE_FIELDS_2, f3
+        #define EOSIO_NATIVE_FIELDS_4 EOSIO_NATIVE_FIELDS_3, f4
+        #define EOSIO_NATIVE_FIELDS_5 EOSIO_NATIVE_FIELDS_4, f5
+        #define EOSIO_NATIVE_FIELDS_6 EOSIO_NATIVE_FIELDS_5, f6
+        #define EOSIO_NATIVE_FIELDS_7 EOSIO_NATIVE_FIELDS_6, f7
+        #define EOSIO_NATIVE_FIELDS_8 EOSIO_NATIVE_FIELDS_7, f8
+        #define EOSIO_NATIVE_FIELDS_9 EOSIO_NATIVE_FIELDS_8, f9
+        #define EOSIO_NATIVE_FIELDS_10 EOSIO_NATIVE_FIELDS_9, f10
+        #define EOSIO_NATIVE_FIELDS_11 EOSIO_NATIVE_FIELDS_10, f11
+        #define EOSIO_NATIVE_FIELDS_12 EOSIO_NATIVE_FIELDS_11, f12
+        #define EOSIO_NATIVE_FIELDS_13 EOSIO_NATIVE_FIELDS_12, f13
+        #define EOSIO_NATIVE_FIELDS_14 EOSIO_NATIVE_FIELDS_13, f14
+        #define EOSIO_NATIVE_FIELDS_15 EOSIO_NATIVE_FIELDS_14, f15
+        #define EOSIO_NATIVE_FIELDS_16 EOSIO_NATIVE_FIELDS_15, f16
+        #define EOSIO_NATIVE_TIE( N ) \
+            if constexpr ( count == N ) { \
+                auto& [ EOSIO_NATIVE_FIELDS_##N ] = t; \
+                f( EOSIO_NATIVE_FIELDS_##N ); \
+            }
+
+        // calls f with every field of the aggregate t
+        template<typename T, typename F>
+        void for_each_field(T& t, F&& f) {
+            constexpr size_t count = field_count<std::remove_const_t<T>>();
+            static_assert( count > 0 && count <= 16, "aggregate has too many fields to reflect" );
+            EOSIO_NATIVE_TIE( 1 ) EOSIO_NATIVE_TIE( 2 ) EOSIO_NATIVE_TIE( 3 ) EOSIO_NATIVE_TIE( 4 )
+            EOSIO_NATIVE_TIE( 5 ) EOSIO_NATIVE_TIE( 6 ) EOSIO_NATIVE_TIE( 7 ) EOSIO_NATIVE_TIE( 8 )
+            EOSIO_NATIVE_TIE( 9 ) EOSIO_NATIVE_TIE( 10 ) EOSIO_NATIVE_TIE( 11 ) EOSIO_NATIVE_TIE( 12 )
+            EOSIO_NATIVE_TIE( 13 ) EOSIO_NATIVE_TIE( 14 ) EOSIO_NATIVE_TIE( 15 ) EOSIO_NATIVE_TIE( 16 )
+        }
+
+        #undef EOSIO_NATIVE_TIE
+    }
+
+    template<typename Stream, typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
+    Stream& operator<<(Stream& ds, const T& v) {
+        ds.write( reinterpret_cast<const char*>( &v ), sizeof( T ) );
+        return ds;
+    }
+
+    template<typename Stream, typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
+    Stream& operator>>(Stream& ds, T& v) {
+        ds.read( reinterpret_cast<char*>( &v ), sizeof( T ) );
+        return ds;
+    }
+
+    template<typename Stream>
+    Stream& operator<<(Stream& ds, const uint128_t& v) {
+        ds.write( reinterpret_cast<const char*>( &v ), sizeof( v ) );
+        return ds;
+    }
+
+    template<typename Stream>
+    Stream& operator>>(Stream& ds, uint128_t& v) {
+        ds.read( reinterpret_cast<char*>( &v ), sizeof( v ) );
+        return ds;
+    }
+
+    template<typename Stream>
+    Stream& operator<<(Stream& ds, const std::string& v) {
+        ds << unsigned_int( v.size() );
+        if ( !v.empty() ) {
+            ds.write( v.data(), v.size() );
+        }
+        return ds;
+    }
+
+    template<typename Stream>
+    Stream& operator>>(Stream& ds, std::string& v) {
+        unsigned_int s;
+        ds >> s;
+        v.resize( s.value );
+        if ( s.value > 0 ) {
+            ds.read( v.data(), s.value );
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T>
+    Stream& operator<<(Stream& ds, const std::vector<T>& v) {
+        ds << unsigned_int( v.size() );
+        for ( const auto& i: v ) {
+            ds << i;
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T>
+    Stream& operator>>(Stream& ds, std::vector<T>& v) {
+        unsigned_int s;
+        ds >> s;
+        v.resize( s.value );
+        for ( auto& i: v ) {
+            ds >> i;
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T, size_t N>
+    Stream& operator<<(Stream& ds, const std::array<T, N>& v) {
+        for ( const auto& i: v ) {
+            ds << i;
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T, size_t N>
+    Stream& operator>>(Stream& ds, std::array<T, N>& v) {
+        for ( auto& i: v ) {
+            ds >> i;
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T>
+    Stream& operator<<(Stream& ds, const std::optional<T>& v) {
+        ds << v.has_value();
+        if ( v.has_value() ) {
+            ds << *v;
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename T>
+    Stream& operator>>(Stream& ds, std::optional<T>& v) {
+        bool has_value = false;
+        ds >> has_value;
+        if ( has_value ) {
+            T val;
+            ds >> val;
+            v = std::move( val );
+        } else {
+            v.reset();
+        }
+        return ds;
+    }
+
+    template<typename Stream, typename A, typename B>
+    Stream& operator<<(Stream& ds, const std::pair<A, B>& v) {
+        return ds << v.first << v.second;
+    }
+
+    template<typename Stream, typename A, typename B>
+    Stream& operator>>(Stream& ds, std::pair<A, B>& v) {
+        return ds >> v.first >> v.second;
+    }
+
+    template<typename Stream, typename... Args>
+    Stream& operator<<(Stream& ds, const std::tuple<Args...>& t) {
+        std::apply( [&]( const auto&... a ) { ( ( ds << a ), ... ); }, t );
+        return ds;
+    }
+
+    template<typename Stream, typename... Args>
+    Stream& operator>>(Stream& ds, std::tuple<Args...>& t) {
+        std::apply( [&]( auto&... a ) { ( ( ds >> a ), ... ); }, t );
+        return ds;
+    }
+
+    // structs without EOSLIB_SERIALIZE, cdt reflects them the same way
+    template<typename Stream, typename T, std::enable_if_t<detail::is_reflected<T>>* = nullptr>
+    Stream& operator<<(Stream& ds, const T& t) {
+        detail::for_each_field( t, [&]( const auto&... f ) { ( ( ds << f ), ... ); } );
+        return ds;
+    }
+
+    template<typename Stream, typename T, std::enable_if_t<detail::is_reflected<T>>* = nullptr>
+    Stream& operator>>(Stream& ds, T& t) {
+        detail::for_each_field( t, [&]( auto&... f ) { ( ( ds >> f ), ... ); } );
+        return ds;
+    }
+
+    template<typename T>
+    size_t pack_size(const T& value) {
+        datastream<size_t> ps;
+        ps << value;
+        return ps.tellp();
+    }
+
+    template<typename T>
+    std::vector<char> pack(const T& value) {
+        std::vector<char> result;
+        result.resize( pack_size( value ) );
+        datastream<char*> ds( result.data(), result.size() );
+        ds << value;
+        return result;
+    }
+
+    template<typename T>
+    T unpack(const char* buffer, size_t len) {
+        T result;
+        datastream<const char*> ds( buffer, len );
+        ds >> result;
+        return result;
+    }
+
+    template<typename T>
+    T unpack(const std::vector<char>& bytes) {
+        return unpack<T>( bytes.data(), bytes.size() );
+    }
+}
+
+// BOOST_PP_SEQ_FOR_EACH over (a)(b)(c): PREFIX_A and PREFIX_B alternate on each element and the
+// name left after the last one is pasted with _END, which expands to nothing
+#define EOSIO_NATIVE_SEQ( PREFIX, SEQ ) EOSIO_NATIVE_SEQ_CAT( PREFIX##_A SEQ, _END )
+#define EOSIO_NATIVE_SEQ_CAT( a, b ) EOSIO_NATIVE_SEQ_CAT_I( a, b )
+#define EOSIO_NATIVE_SEQ_CAT_I( a, b ) a ## b
+
+#define EOSIO_NATIVE_OUT_A( elem ) ds << t.elem; EOSIO_NATIVE_OUT_B
+#define EOSIO_NATIVE_OUT_B( elem ) ds << t.elem; EOSIO_NATIVE_OUT_A
+#define EOSIO_NATIVE_OUT_A_END
+#define EOSIO_NATIVE_OUT_B_END
+#define EOSIO_NATIVE_IN_A( elem ) ds >> t.elem; EOSIO_NATIVE_IN_B
+#define EOSIO_NATIVE_IN_B( elem ) ds >> t.elem; EOSIO_NATIVE_IN_A
+#define EOSIO_NATIVE_IN_A_END
+#define EOSIO_NATIVE_IN_B_END
+
+// same expansion as cdt, friends found by ADL through the enclosing contract class
+#define EOSLIB_SERIALIZE( TYPE, MEMBERS ) \
+    template<typename DataStream> \
+    friend DataStream& operator<<( DataStream& ds, const TYPE& t ) { \
+        EOSIO_NATIVE_SEQ( EOSIO_NATIVE_OUT, MEMBERS ) \
+        return ds; \
+    } \
+    template<typename DataStream> \
+    friend DataStream& operator>>( DataStream& ds, TYPE& t ) { \
+        EOSIO_NATIVE_SEQ( EOSIO_NATIVE_IN, MEMBERS ) \
+        return ds; \
+    }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "action.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+
+namespace eosio {
+
+    // unpacks the action data into the arguments of a void member, like cdt it does not take
+    // members returning a value, those need set_action_return_value
+    template<typename T, typename... Args>
+    bool execute_action(name self, name code, void (T::*func)(Args...)) {
+        std::vector<char> buffer( action_data_size() );
+        if ( !buffer.empty() ) {
+            read_action_data( buffer.data(), uint32_t( buffer.size() ) );
+        }
+        std::tuple<std::decay_t<Args>...> args;
+        datastream<const char*> ds( buffer.data(), buffer.size() );
+        ds >> args;
+        T inst( self, code, ds );
+        std::apply( [&]( auto&... a ) { ( ( &inst )->*func )( a... ); }, args );
+        return true;
+    }
+}
+
+#define EOSIO_NATIVE_DISPATCH_A( elem ) \
+    case eosio::name( #elem ).value: \
+        eosio::execute_action( eosio::name( receiver ), eosio::name( code ), &eosio_native_dispatch_type::elem ); \
+        break; \
+    EOSIO_NATIVE_DISPATCH_B
+#define EOSIO_NATIVE_DISPATCH_B( elem ) \
+    case eosio::name( #elem ).value: \
+        eosio::execute_action( eosio::name( receiver ), eosio::name( code ), &eosio_native_dispatch_type::elem ); \
+        break; \
+    EOSIO_NATIVE_DISPATCH_A
+#define EOSIO_NATIVE_DISPATCH_A_END
+#define EOSIO_NATIVE_DISPATCH_B_END
+
+// cases of the switch on the action name, one for each member
+#define EOSIO_DISPATCH_HELPER( TYPE, MEMBERS ) \
+    using eosio_native_dispatch_type = TYPE; \
+    EOSIO_NATIVE_SEQ( EOSIO_NATIVE_DISPATCH, MEMBERS )
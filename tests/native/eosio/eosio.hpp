@@ -0,0 +1,18 @@
+#pragma once
+
+// native stand-in for eosio.cdt, builds a contract into a host program running on the in-memory
+// chain of native.hpp so it can be tested and profiled without nodeos
+
+#include "action.hpp"
+#include "check.hpp"
+#include "contract.hpp"
+#include "datastream.hpp"
+#include "dispatcher.hpp"
+#include "multi_index.hpp"
+#include "name.hpp"
+#include "print.hpp"
+#include "system.hpp"
+
+#define CONTRACT class [[eosio::contract]]
+#define ACTION [[eosio::action]] void
+#define TABLE struct [[eosio::table]]
@@ -0,0 +1,501 @@
+#pragma once
+
+// multi_index of eosio.cdt over the in-memory chain. Like cdt it caches every row it loads so
+// references stay valid for the life of the table object, keeps each secondary index as its own
+// table of ( key, primary key ) entries and only updates an index entry when its key changed.
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+#include "native.hpp"
+
+namespace eosio {
+
+    constexpr static inline name same_payer{};
+
+    template<class Class, typename Type, Type (Class::*PtrToMemberFunction)() const>
+    struct const_mem_fun {
+        typedef typename std::remove_reference<Type>::type result_type;
+
+        Type operator()(const Class& x) const { return ( x.*PtrToMemberFunction )(); }
+    };
+
+    template<name::raw IndexName, typename Extractor>
+    struct indexed_by {
+        static constexpr uint64_t index_name = static_cast<uint64_t>( IndexName );
+        typedef Extractor secondary_extractor_type;
+    };
+
+    template<name::raw TableName, typename T, typename... Indices>
+    class multi_index {
+        private:
+            static_assert( sizeof...( Indices ) <= 16, "multi_index only supports a maximum of 16 secondary indices" );
+
+            constexpr static uint64_t unset_next_primary_key = static_cast<uint64_t>( -1 );
+            constexpr static uint64_t no_available_primary_key = static_cast<uint64_t>( -2 );
+
+            struct item : public T {
+                template<typename Constructor>
+                item(const multi_index* idx, Constructor&& c) : __idx( idx ) { c( *this ); }
+
+                const multi_index* __idx;
+            };
+
+            struct item_ptr {
+                std::unique_ptr<item> _item;
+                uint64_t _primary_key;
+            };
+
+            template<size_t I>
+            using nth_index = std::tuple_element_t<I, std::tuple<Indices...>>;
+
+            template<size_t I>
+            using index_key = std::decay_t<decltype( typename nth_index<I>::secondary_extractor_type()( std::declval<const T&>() ) )>;
+
+            template<uint64_t IndexName>
+            static constexpr size_t index_position() {
+                size_t position = 0;
+                size_t result = sizeof...( Indices );
+                ( ( result = ( result == sizeof...( Indices ) && Indices::index_name == IndexName ) ? position : result, position++ ), ... );
+                return result;
+            }
+
+            template<typename F, size_t... I>
+            static void for_each_index(F&& f, std::index_sequence<I...>) {
+                ( f( std::integral_constant<size_t, I>{} ), ... );
+            }
+
+            template<typename F>
+            static void for_each_index(F&& f) {
+                for_each_index( std::forward<F>( f ), std::index_sequence_for<Indices...>{} );
+            }
+
+            template<size_t I>
+            static index_key<I> extract(const T& obj) {
+                return typename nth_index<I>::secondary_extractor_type()( obj );
+            }
+
+            template<size_t... I>
+            static auto extract_all(const T& obj, std::index_sequence<I...>) {
+                return std::make_tuple( extract<I>( obj )... );
+            }
+
+            name _code;
+            uint64_t _scope;
+            mutable uint64_t _next_primary_key = unset_next_primary_key;
+            mutable std::vector<item_ptr> _items_vector;
+
+            native::table_key primary_table() const {
+                return { _code.value, _scope, static_cast<uint64_t>( TableName ) };
+            }
+
+            native::table_key index_table(uint64_t number) const {
+                return { _code.value, _scope, ( static_cast<uint64_t>( TableName ) & 0xFFFFFFFFFFFFFFF0ULL ) | ( number & 0xFULL ) };
+            }
+
+            const item& load_object_by_primary(uint64_t primary) const {
+                auto cached = std::find_if( _items_vector.rbegin(), _items_vector.rend(), [primary]( const item_ptr& ptr ) {
+                    return ptr._primary_key == primary;
+                });
+                if ( cached != _items_vector.rend() ) {
+                    return *cached->_item;
+                }
+                auto row = native::chain::current().db_get( primary_table(), primary );
+                check( row != nullptr, "unable to load object" );
+                auto ptr = std::make_unique<item>( this, [&]( auto& i ) {
+                    T& val = static_cast<T&>( i );
+                    datastream<const char*> ds( row->data.data(), row->data.size() );
+                    ds >> val;
+                });
+                const item& result = *ptr;
+                _items_vector.push_back( { std::move( ptr ), primary } );
+                return result;
+            }
+
+            const item* find_cached_or_load(uint64_t primary) const {
+                auto cached = std::find_if( _items_vector.rbegin(), _items_vector.rend(), [primary]( const item_ptr& ptr ) {
+                    return ptr._primary_key == primary;
+                });
+                if ( cached != _items_vector.rend() ) {
+                    return cached->_item.get();
+                }
+                if ( native::chain::current().db_get( primary_table(), primary ) == nullptr ) {
+                    return nullptr;
+                }
+                return &load_object_by_primary( primary );
+            }
+
+        public:
+            template<uint64_t IndexName, typename Extractor, uint64_t Number>
+            struct index {
+                public:
+                    typedef Extractor secondary_extractor_type;
+                    typedef std::decay_t<decltype( Extractor()( std::declval<const T&>() ) )> secondary_key_type;
+
+                    constexpr static uint64_t index_number() { return Number; }
+                    constexpr static uint64_t name() { return IndexName; }
+
+                    struct const_iterator {
+                        public:
+                            using iterator_category = std::bidirectional_iterator_tag;
+                            using value_type = const T;
+                            using difference_type = std::ptrdiff_t;
+                            using pointer = const T*;
+                            using reference = const T&;
+
+                            const_iterator() {}
+
+                            friend bool operator==(const const_iterator& a, const const_iterator& b) { return a._item == b._item; }
+                            friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a._item != b._item; }
+
+                            const T& operator*() const { return *static_cast<const T*>( _item ); }
+                            const T* operator->() const { return static_cast<const T*>( _item ); }
+
+                            const_iterator operator++(int) {
+                                const_iterator result( *this );
+                                ++( *this );
+                                return result;
+                            }
+
+                            const_iterator operator--(int) {
+                                const_iterator result( *this );
+                                --( *this );
+                                return result;
+                            }
+
+                            const_iterator& operator++() {
+                                check( _item != nullptr, "cannot increment end iterator" );
+                                auto& c = native::chain::current();
+                                auto table = _multidx->index_table( Number );
+                                auto key = c.template idx_key<secondary_key_type>( table, _item->primary_key() );
+                                check( key != nullptr, "could not find secondary key of object" );
+                                auto next = c.template idx_lower_bound<secondary_key_type>( table, *key, _item->primary_key(), true );
+                                _item = next ? &_multidx->load_object_by_primary( next->second ) : nullptr;
+                                return *this;
+                            }
+
+                            const_iterator& operator--() {
+                                auto& c = native::chain::current();
+                                auto table = _multidx->index_table( Number );
+                                if ( _item == nullptr ) {
+                                    auto last = c.template idx_last<secondary_key_type>( table );
+                                    check( last.has_value(), "cannot decrement end iterator when the index is empty" );
+                                    _item = &_multidx->load_object_by_primary( last->second );
+                                    return *this;
+                                }
+                                auto key = c.template idx_key<secondary_key_type>( table, _item->primary_key() );
+                                check( key != nullptr, "could not find secondary key of object" );
+                                auto previous = c.template idx_previous<secondary_key_type>( table, *key, _item->primary_key() );
+                                check( previous.has_value(), "cannot decrement iterator at beginning of index" );
+                                _item = &_multidx->load_object_by_primary( previous->second );
+                                return *this;
+                            }
+
+                        private:
+                            friend struct index;
+
+                            const_iterator(const multi_index* mi, const item* i = nullptr) : _multidx( mi ), _item( i ) {}
+
+                            const multi_index* _multidx = nullptr;
+                            const item* _item = nullptr;
+                    };
+
+                    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+                    const_iterator cbegin() const { return lower_bound( secondary_key_type{} ); }
+                    const_iterator begin() const { return cbegin(); }
+                    const_iterator cend() const { return const_iterator( _multidx ); }
+                    const_iterator end() const { return cend(); }
+                    const_reverse_iterator crbegin() const { return std::make_reverse_iterator( cend() ); }
+                    const_reverse_iterator rbegin() const { return crbegin(); }
+                    const_reverse_iterator crend() const { return std::make_reverse_iterator( cbegin() ); }
+                    const_reverse_iterator rend() const { return crend(); }
+
+                    const_iterator find(const secondary_key_type& secondary) const {
+                        auto lb = lower_bound( secondary );
+                        auto e = cend();
+                        if ( lb == e ) return e;
+                        if ( secondary != Extractor()( *lb ) ) return e;
+                        return lb;
+                    }
+
+                    const T& get(const secondary_key_type& secondary, const char* error_msg = "unable to find secondary key") const {
+                        auto result = find( secondary );
+                        check( result != cend(), error_msg );
+                        return *result;
+                    }
+
+                    const_iterator lower_bound(const secondary_key_type& secondary) const {
+                        auto next = native::chain::current().template idx_lower_bound<secondary_key_type>(
+                            _multidx->index_table( Number ), secondary, 0 );
+                        if ( !next ) return cend();
+                        return const_iterator( _multidx, &_multidx->load_object_by_primary( next->second ) );
+                    }
+
+                    const_iterator upper_bound(const secondary_key_type& secondary) const {
+                        auto next = native::chain::current().template idx_lower_bound<secondary_key_type>(
+                            _multidx->index_table( Number ), secondary, std::numeric_limits<uint64_t>::max(), true );
+                        if ( !next ) return cend();
+                        return const_iterator( _multidx, &_multidx->load_object_by_primary( next->second ) );
+                    }
+
+                    const_iterator iterator_to(const T& obj) const {
+                        const auto& objitem = static_cast<const item&>( obj );
+                        check( objitem.__idx == _multidx, "object passed to iterator_to is not in multi_index" );
+                        auto key = native::chain::current().template idx_key<secondary_key_type>(
+                            _multidx->index_table( Number ), objitem.primary_key() );
+                        check( key != nullptr && *key == Extractor()( obj ), "object does not have an entry in the index" );
+                        return const_iterator( _multidx, &objitem );
+                    }
+
+                    template<typename Lambda>
+                    void modify(const_iterator itr, eosio::name payer, Lambda&& updater) {
+                        check( itr != cend(), "cannot pass end iterator to modify" );
+                        const_cast<multi_index*>( _multidx )->modify( *itr, payer, std::forward<Lambda>( updater ) );
+                    }
+
+                    const_iterator erase(const_iterator itr) {
+                        check( itr != cend(), "cannot pass end iterator to erase" );
+                        const auto& obj = *itr;
+                        ++itr;
+                        const_cast<multi_index*>( _multidx )->erase( obj );
+                        return itr;
+                    }
+
+                    eosio::name get_code() const { return _multidx->get_code(); }
+                    uint64_t get_scope() const { return _multidx->get_scope(); }
+
+                    index(const multi_index* idx) : _multidx( idx ) {}
+
+                private:
+                    const multi_index* _multidx;
+            };
+
+            struct const_iterator {
+                public:
+                    using iterator_category = std::bidirectional_iterator_tag;
+                    using value_type = const T;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const T*;
+                    using reference = const T&;
+
+                    const_iterator() {}
+
+                    friend bool operator==(const const_iterator& a, const const_iterator& b) { return a._item == b._item; }
+                    friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a._item != b._item; }
+
+                    const T& operator*() const { return *static_cast<const T*>( _item ); }
+                    const T* operator->() const { return static_cast<const T*>( _item ); }
+
+                    const_iterator operator++(int) {
+                        const_iterator result( *this );
+                        ++( *this );
+                        return result;
+                    }
+
+                    const_iterator operator--(int) {
+                        const_iterator result( *this );
+                        --( *this );
+                        return result;
+                    }
+
+                    const_iterator& operator++() {
+                        check( _item != nullptr, "cannot increment end iterator" );
+                        auto next = native::chain::current().db_lower_bound( _multidx->primary_table(), _item->primary_key(), true );
+                        _item = next ? &_multidx->load_object_by_primary( *next ) : nullptr;
+                        return *this;
+                    }
+
+                    const_iterator& operator--() {
+                        auto& c = native::chain::current();
+                        if ( _item == nullptr ) {
+                            auto last = c.db_last( _multidx->primary_table() );
+                            check( last.has_value(), "cannot decrement end iterator when the table is empty" );
+                            _item = &_multidx->load_object_by_primary( *last );
+                            return *this;
+                        }
+                        auto previous = c.db_previous( _multidx->primary_table(), _item->primary_key() );
+                        check( previous.has_value(), "cannot decrement iterator at beginning of table" );
+                        _item = &_multidx->load_object_by_primary( *previous );
+                        return *this;
+                    }
+
+                private:
+                    friend class multi_index;
+
+                    const_iterator(const multi_index* mi, const item* i = nullptr) : _multidx( mi ), _item( i ) {}
+
+                    const multi_index* _multidx = nullptr;
+                    const item* _item = nullptr;
+            };
+
+            typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+            multi_index(name code, uint64_t scope) : _code( code ), _scope( scope ) {}
+
+            multi_index(const multi_index&) = delete;
+            multi_index& operator=(const multi_index&) = delete;
+
+            name get_code() const { return _code; }
+            uint64_t get_scope() const { return _scope; }
+
+            const_iterator cbegin() const { return lower_bound( std::numeric_limits<uint64_t>::lowest() ); }
+            const_iterator begin() const { return cbegin(); }
+            const_iterator cend() const { return const_iterator( this ); }
+            const_iterator end() const { return cend(); }
+            const_reverse_iterator crbegin() const { return std::make_reverse_iterator( cend() ); }
+            const_reverse_iterator rbegin() const { return crbegin(); }
+            const_reverse_iterator crend() const { return std::make_reverse_iterator( cbegin() ); }
+            const_reverse_iterator rend() const { return crend(); }
+
+            const_iterator lower_bound(uint64_t primary) const {
+                auto next = native::chain::current().db_lower_bound( primary_table(), primary );
+                if ( !next ) return end();
+                return const_iterator( this, &load_object_by_primary( *next ) );
+            }
+
+            const_iterator upper_bound(uint64_t primary) const {
+                auto next = native::chain::current().db_lower_bound( primary_table(), primary, true );
+                if ( !next ) return end();
+                return const_iterator( this, &load_object_by_primary( *next ) );
+            }
+
+            uint64_t available_primary_key() const {
+                if ( _next_primary_key == unset_next_primary_key ) {
+                    if ( begin() == end() ) {
+                        _next_primary_key = 0;
+                    } else {
+                        auto itr = --end();
+                        auto pk = itr->primary_key();
+                        _next_primary_key = pk >= no_available_primary_key ? no_available_primary_key : pk + 1;
+                    }
+                }
+                check( _next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit" );
+                return _next_primary_key;
+            }
+
+            template<name::raw IndexName>
+            auto get_index() const {
+                constexpr size_t position = index_position<static_cast<uint64_t>( IndexName )>();
+                static_assert( position < sizeof...( Indices ), "name provided is not the name of any secondary index within multi_index" );
+                return index<static_cast<uint64_t>( IndexName ), typename nth_index<position>::secondary_extractor_type, position>( this );
+            }
+
+            const_iterator iterator_to(const T& obj) const {
+                const auto& objitem = static_cast<const item&>( obj );
+                check( objitem.__idx == this, "object passed to iterator_to is not in multi_index" );
+                return const_iterator( this, &objitem );
+            }
+
+            template<typename Lambda>
+            const_iterator emplace(name payer, Lambda&& constructor) {
+                auto& c = native::chain::current();
+                check( _code == c.receiver(), "cannot create objects in table of another contract" );
+
+                auto ptr = std::make_unique<item>( this, [&]( auto& i ) {
+                    T& obj = static_cast<T&>( i );
+                    constructor( obj );
+                });
+                const item& i = *ptr;
+                uint64_t pk = i.primary_key();
+                c.db_store( primary_table(), payer, pk, pack( static_cast<const T&>( i ) ) );
+                if ( pk >= _next_primary_key ) {
+                    _next_primary_key = pk >= no_available_primary_key ? no_available_primary_key : pk + 1;
+                }
+                for_each_index( [&]( auto n ) {
+                    constexpr size_t I = decltype( n )::value;
+                    c.template idx_store<index_key<I>>( index_table( I ), payer, pk, extract<I>( i ) );
+                });
+
+                _items_vector.push_back( { std::move( ptr ), pk } );
+                return const_iterator( this, &i );
+            }
+
+            template<typename Lambda>
+            void modify(const_iterator itr, name payer, Lambda&& updater) {
+                check( itr != end(), "cannot pass end iterator to modify" );
+                modify( *itr, payer, std::forward<Lambda>( updater ) );
+            }
+
+            template<typename Lambda>
+            void modify(const T& obj, name payer, Lambda&& updater) {
+                const auto& objitem = static_cast<const item&>( obj );
+                check( objitem.__idx == this, "object passed to modify is not in multi_index" );
+                auto& mutableitem = const_cast<item&>( objitem );
+                auto& c = native::chain::current();
+                check( _code == c.receiver(), "cannot modify objects in table of another contract" );
+
+                auto pk = obj.primary_key();
+                auto secondary_keys = extract_all( obj, std::index_sequence_for<Indices...>{} );
+
+                updater( static_cast<T&>( mutableitem ) );
+
+                check( pk == obj.primary_key(), "updater cannot change primary key when modifying an object" );
+                c.db_update( primary_table(), payer, pk, pack( obj ) );
+                if ( pk >= _next_primary_key ) {
+                    _next_primary_key = pk >= no_available_primary_key ? no_available_primary_key : pk + 1;
+                }
+                for_each_index( [&]( auto n ) {
+                    constexpr size_t I = decltype( n )::value;
+                    auto secondary = extract<I>( obj );
+                    if ( secondary != std::get<I>( secondary_keys ) ) {
+                        c.template idx_update<index_key<I>>( index_table( I ), payer, pk, secondary );
+                    }
+                });
+            }
+
+            const_iterator erase(const_iterator itr) {
+                check( itr != end(), "cannot pass end iterator to erase" );
+                const auto& obj = *itr;
+                ++itr;
+                erase( obj );
+                return itr;
+            }
+
+            void erase(const T& obj) {
+                const auto& objitem = static_cast<const item&>( obj );
+                check( objitem.__idx == this, "object passed to erase is not in multi_index" );
+                auto& c = native::chain::current();
+                check( _code == c.receiver(), "cannot erase objects in table of another contract" );
+
+                auto pk = objitem.primary_key();
+                c.db_remove( primary_table(), pk );
+                for_each_index( [&]( auto n ) {
+                    constexpr size_t I = decltype( n )::value;
+                    c.template idx_remove<index_key<I>>( index_table( I ), pk );
+                });
+
+                auto cached = std::find_if( _items_vector.begin(), _items_vector.end(), [&objitem]( const item_ptr& ptr ) {
+                    return ptr._item.get() == &objitem;
+                });
+                check( cached != _items_vector.end(), "attempt to remove object that was not in multi_index" );
+                _items_vector.erase( cached );
+            }
+
+            const_iterator find(uint64_t primary) const {
+                auto i = find_cached_or_load( primary );
+                return i == nullptr ? end() : const_iterator( this, i );
+            }
+
+            const_iterator require_find(uint64_t primary, const char* error_msg = "unable to find key") const {
+                auto i = find_cached_or_load( primary );
+                check( i != nullptr, error_msg );
+                return const_iterator( this, i );
+            }
+
+            const T& get(uint64_t primary, const char* error_msg = "unable to find key") const {
+                auto i = find_cached_or_load( primary );
+                check( i != nullptr, error_msg );
+                return *i;
+            }
+    };
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "check.hpp"
+
+namespace eosio {
+
+    // account and action names, same encoding as eosio.cdt
+    struct name {
+        enum class raw : uint64_t {};
+
+        uint64_t value = 0;
+
+        constexpr name() = default;
+        constexpr explicit name(uint64_t v) : value( v ) {}
+        constexpr explicit name(raw r) : value( static_cast<uint64_t>( r ) ) {}
+
+        constexpr explicit name(std::string_view str) {
+            if ( str.size() > 13 ) {
+                check( false, "string is too long to be a valid name" );
+            }
+            if ( str.empty() ) {
+                return;
+            }
+            auto n = std::min( size_t( str.size() ), size_t( 12 ) );
+            for ( decltype( n ) i = 0; i < n; ++i ) {
+                value <<= 5;
+                value |= char_to_value( str[i] );
+            }
+            value <<= ( 4 + 5 * ( 12 - n ) );
+            if ( str.size() == 13 ) {
+                uint64_t v = char_to_value( str[12] );
+                if ( v > 0x0Full ) {
+                    check( false, "thirteenth character in name cannot be a letter that comes after j" );
+                }
+                value |= v;
+            }
+        }
+
+        static constexpr uint8_t char_to_value(char c) {
+            if ( c == '.' ) return 0;
+            else if ( c >= '1' && c <= '5' ) return ( c - '1' ) + 1;
+            else if ( c >= 'a' && c <= 'z' ) return ( c - 'a' ) + 6;
+            else check( false, "character is not in allowed character set for names" );
+            return 0;
+        }
+
+        constexpr uint8_t length() const {
+            constexpr uint64_t mask = 0xF800000000000000ull;
+            if ( value == 0 ) return 0;
+            uint8_t l = 0;
+            uint8_t i = 0;
+            for ( auto v = value; i < 13; ++i, v <<= ( i == 12 ? 4 : 5 ) ) {
+                if ( ( v & mask ) > 0 ) {
+                    l = i;
+                }
+            }
+            return l + 1;
+        }
+
+        std::string to_string() const {
+            static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+            constexpr uint64_t mask = 0xF800000000000000ull;
+            std::string str( 13, '.' );
+            auto v = value;
+            for ( int i = 0; i < 13; ++i, v <<= 5 ) {
+                if ( v == 0 ) break;
+                auto indx = ( v & mask ) >> ( i == 12 ? 60 : 59 );
+                str[i] = charmap[indx];
+            }
+            str.resize( length() );
+            return str;
+        }
+
+        constexpr operator raw() const { return raw( value ); }
+        constexpr explicit operator bool() const { return value != 0; }
+
+        friend constexpr bool operator==(const name& a, const name& b) { return a.value == b.value; }
+        friend constexpr bool operator!=(const name& a, const name& b) { return a.value != b.value; }
+        friend constexpr bool operator<(const name& a, const name& b) { return a.value < b.value; }
+
+        template<typename DataStream>
+        friend DataStream& operator<<(DataStream& ds, const name& n) {
+            ds.write( reinterpret_cast<const char*>( &n.value ), sizeof( n.value ) );
+            return ds;
+        }
+
+        template<typename DataStream>
+        friend DataStream& operator>>(DataStream& ds, name& n) {
+            ds.read( reinterpret_cast<char*>( &n.value ), sizeof( n.value ) );
+            return ds;
+        }
+    };
+
+    namespace detail {
+        template <char... Str>
+        struct to_const_char_arr {
+            static constexpr const char value[] = { Str... };
+        };
+    }
+
+    inline namespace literals {
+        template <typename T, T... Str>
+        constexpr name operator""_n() {
+            return name( std::string_view{ detail::to_const_char_arr<Str...>::value, sizeof...(Str) } );
+        }
+    }
+}
+
+#pragma GCC diagnostic ignored "-Wpedantic"
+using namespace eosio::literals;
@@ -0,0 +1,322 @@
+#pragma once
+
+// in-memory chain behind the native stand-in for eosio.cdt. It keeps contract tables as packed rows
+// with their secondary indices, bills RAM the way nodeos does, checks authorizations, delivers
+// notifications and inline actions and reverts every change of a failed transaction.
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "check.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+#include "time.hpp"
+
+namespace eosio {
+
+    struct permission_level {
+        name actor;
+        name permission;
+
+        permission_level() {}
+        permission_level(name a, name p) : actor( a ), permission( p ) {}
+
+        friend bool operator==(const permission_level& a, const permission_level& b) {
+            return a.actor == b.actor && a.permission == b.permission;
+        }
+
+        EOSLIB_SERIALIZE( permission_level, (actor)(permission) )
+    };
+
+    namespace native {
+
+        // billable sizes of nodeos: a row costs 108 bytes on top of its data, every secondary
+        // index entry 120 bytes plus its key and every table, primary or secondary, 108 bytes
+        constexpr int64_t row_overhead = 108;
+        constexpr int64_t table_overhead = 108;
+        template<typename K>
+        constexpr int64_t index_overhead = 120 + sizeof( K );
+
+        // db calls of the running action and the bytes they moved
+        struct db_counters {
+            uint64_t reads = 0;
+            uint64_t writes = 0;
+            uint64_t erases = 0;
+            uint64_t bytes_read = 0;
+            uint64_t bytes_written = 0;
+        };
+
+        struct table_key {
+            uint64_t code;
+            uint64_t scope;
+            uint64_t table;
+
+            friend bool operator<(const table_key& a, const table_key& b) {
+                return std::tie( a.code, a.scope, a.table ) < std::tie( b.code, b.scope, b.table );
+            }
+        };
+
+        struct row {
+            std::vector<char> data;
+            name payer;
+        };
+
+        struct table {
+            std::map<uint64_t, row> rows;
+        };
+
+        // table_id_object of nodeos, shared by the rows of a table and the entries of its first
+        // secondary index since both carry the table name, billed to whoever created it
+        struct table_id {
+            name payer;
+            uint64_t count = 0;
+        };
+
+        struct index_base {
+            virtual ~index_base() = default;
+            virtual size_t size() const = 0;
+            virtual int64_t billed_bytes() const = 0;
+        };
+
+        template<typename K>
+        struct index_table : index_base {
+            struct entry {
+                K key;
+                name payer;
+            };
+            std::set<std::pair<K, uint64_t>> by_key;
+            std::unordered_map<uint64_t, entry> by_primary;
+
+            size_t size() const override { return by_key.size(); }
+            int64_t billed_bytes() const override { return int64_t( by_key.size() ) * index_overhead<K>; }
+        };
+
+        struct action_data {
+            eosio::name account;
+            eosio::name name;
+            std::vector<permission_level> authorization;
+            std::vector<char> data;
+        };
+
+        // what one contract did while handling an action or a notification
+        struct action_trace {
+            eosio::name receiver;
+            action_data act;
+            std::vector<char> return_value;
+            std::string console;
+        };
+
+        using apply_handler = std::function<void(uint64_t receiver, uint64_t code, uint64_t action)>;
+
+        class chain {
+            public:
+                chain();
+                ~chain();
+
+                // the chain the stand-in intrinsics act on, the most recently constructed one
+                static chain& current();
+
+                void create_account(name account);
+                bool is_account(name account) const { return _accounts.count( account.value ) > 0; }
+                void set_code(name account, apply_handler handler) { _code[account.value] = std::move( handler ); }
+
+                time_point now() const { return _now; }
+                void set_now(time_point t) { _now = t; }
+                void advance(int64_t seconds) { _now = _now + eosio::seconds( seconds ); }
+
+                // runs the actions as one transaction, rethrows the first failed check after reverting
+                std::vector<action_trace> push_transaction(const std::vector<action_data>& actions);
+
+                // bytes of RAM billed to account
+                int64_t ram_usage(name account) const {
+                    auto itr = _ram.find( account.value );
+                    return itr == _ram.end() ? 0 : itr->second;
+                }
+
+                // bytes of RAM billed to every account
+                int64_t total_ram() const {
+                    int64_t total = 0;
+                    for ( const auto& [account, bytes]: _ram ) total += bytes;
+                    return total;
+                }
+
+                db_counters& counters() { return _counters; }
+                void reset_counters() { _counters = db_counters(); }
+
+                // intrinsics of the running action
+                name receiver() const { return _receiver; }
+                const action_data& current_action() const { return *_act; }
+                bool has_auth(name account) const;
+                void require_auth(name account) const;
+                void require_recipient(name account);
+                void send_inline(action_data act);
+                void set_action_return_value(const char* data, size_t size);
+                void print(const std::string& s);
+
+                // tables
+                const table* find_table(const table_key& key) const;
+                const row* db_get(const table_key& key, uint64_t primary);
+                // primary key of the first row at or after primary, or past it for upper
+                std::optional<uint64_t> db_lower_bound(const table_key& key, uint64_t primary, bool upper = false);
+                std::optional<uint64_t> db_previous(const table_key& key, uint64_t primary);
+                std::optional<uint64_t> db_last(const table_key& key);
+                void db_store(const table_key& key, name payer, uint64_t primary, std::vector<char> data);
+                void db_update(const table_key& key, name payer, uint64_t primary, std::vector<char> data);
+                void db_remove(const table_key& key, uint64_t primary);
+
+                template<typename K>
+                index_table<K>* find_index(const table_key& key) {
+                    auto itr = _indices.find( key );
+                    return itr == _indices.end() ? nullptr : static_cast<index_table<K>*>( itr->second.get() );
+                }
+
+                template<typename K>
+                const K* idx_key(const table_key& key, uint64_t primary) {
+                    _counters.reads++;
+                    auto idx = find_index<K>( key );
+                    if ( idx == nullptr ) return nullptr;
+                    auto itr = idx->by_primary.find( primary );
+                    return itr == idx->by_primary.end() ? nullptr : &itr->second.key;
+                }
+
+                // primary key of the first entry at or after ( secondary, primary )
+                template<typename K>
+                std::optional<std::pair<K, uint64_t>> idx_lower_bound(const table_key& key, const K& secondary,
+                                                                       uint64_t primary, bool upper = false) {
+                    _counters.reads++;
+                    auto idx = find_index<K>( key );
+                    if ( idx == nullptr ) return std::nullopt;
+                    auto pos = std::make_pair( secondary, primary );
+                    auto itr = upper ? idx->by_key.upper_bound( pos ) : idx->by_key.lower_bound( pos );
+                    if ( itr == idx->by_key.end() ) return std::nullopt;
+                    return *itr;
+                }
+
+                template<typename K>
+                std::optional<std::pair<K, uint64_t>> idx_previous(const table_key& key, const K& secondary, uint64_t primary) {
+                    _counters.reads++;
+                    auto idx = find_index<K>( key );
+                    if ( idx == nullptr ) return std::nullopt;
+                    auto itr = idx->by_key.lower_bound( std::make_pair( secondary, primary ) );
+                    if ( itr == idx->by_key.begin() ) return std::nullopt;
+                    return *--itr;
+                }
+
+                template<typename K>
+                std::optional<std::pair<K, uint64_t>> idx_last(const table_key& key) {
+                    _counters.reads++;
+                    auto idx = find_index<K>( key );
+                    if ( idx == nullptr || idx->by_key.empty() ) return std::nullopt;
+                    return *idx->by_key.rbegin();
+                }
+
+                template<typename K>
+                void idx_store(const table_key& key, name payer, uint64_t primary, const K& secondary) {
+                    _counters.writes++;
+                    auto& slot = _indices[key];
+                    if ( !slot ) {
+                        slot = std::make_unique<index_table<K>>();
+                    }
+                    auto idx = static_cast<index_table<K>*>( slot.get() );
+                    acquire_table( key, payer );
+                    idx->by_key.emplace( secondary, primary );
+                    idx->by_primary[primary] = { secondary, payer };
+                    bill( payer, index_overhead<K> );
+                    _undo.push_back( [idx, primary, secondary]() {
+                        idx->by_key.erase( std::make_pair( secondary, primary ) );
+                        idx->by_primary.erase( primary );
+                    });
+                }
+
+                template<typename K>
+                void idx_update(const table_key& key, name payer, uint64_t primary, const K& secondary) {
+                    _counters.writes++;
+                    auto idx = find_index<K>( key );
+                    // multi_index updates the entry it expects to exist, nodeos fails on the end iterator
+                    check( idx != nullptr && idx->by_primary.count( primary ) > 0, "dereference of end iterator" );
+                    auto& entry = idx->by_primary[primary];
+                    auto old = entry;
+                    if ( payer.value == 0 ) {
+                        payer = old.payer;
+                    }
+                    if ( payer != old.payer ) {
+                        bill( old.payer, -index_overhead<K> );
+                        bill( payer, index_overhead<K> );
+                    }
+                    idx->by_key.erase( std::make_pair( old.key, primary ) );
+                    idx->by_key.emplace( secondary, primary );
+                    entry = { secondary, payer };
+                    _undo.push_back( [idx, primary, secondary, old]() {
+                        idx->by_key.erase( std::make_pair( secondary, primary ) );
+                        idx->by_key.emplace( old.key, primary );
+                        idx->by_primary[primary] = old;
+                    });
+                }
+
+                // entries written before an index existed are missing, like multi_index erase skips them
+                template<typename K>
+                void idx_remove(const table_key& key, uint64_t primary) {
+                    auto idx = find_index<K>( key );
+                    if ( idx == nullptr ) return;
+                    auto itr = idx->by_primary.find( primary );
+                    if ( itr == idx->by_primary.end() ) return;
+                    _counters.erases++;
+                    auto old = itr->second;
+                    idx->by_key.erase( std::make_pair( old.key, primary ) );
+                    idx->by_primary.erase( itr );
+                    bill( old.payer, -index_overhead<K> );
+                    release_table( key );
+                    _undo.push_back( [idx, primary, old]() {
+                        idx->by_key.emplace( old.key, primary );
+                        idx->by_primary[primary] = old;
+                    });
+                }
+
+                // rows and bytes billed for a table over every scope, secondary indices included
+                struct table_usage {
+                    uint64_t rows = 0;
+                    int64_t data_bytes = 0;
+                    int64_t billed_bytes = 0;
+                };
+                table_usage usage(name code, name table) const;
+
+                // raw access for tests, written as if by the contract of code
+                void raw_store(const table_key& key, name payer, uint64_t primary, std::vector<char> data);
+
+            private:
+                void bill(name payer, int64_t delta);
+                void acquire_table(const table_key& key, name payer);
+                void release_table(const table_key& key);
+                void execute(const action_data& act, std::vector<action_trace>& traces, int depth);
+                void apply(const action_data& act, name receiver, std::vector<name>& notified,
+                           std::vector<action_data>& inline_actions, std::vector<action_trace>& traces);
+
+                std::set<uint64_t> _accounts;
+                std::map<uint64_t, apply_handler> _code;
+                std::map<uint64_t, int64_t> _ram;
+                std::map<table_key, table> _tables;
+                std::map<table_key, std::unique_ptr<index_base>> _indices;
+                std::map<table_key, table_id> _table_ids;
+                std::vector<std::function<void()>> _undo;
+                time_point _now;
+                db_counters _counters;
+
+                name _receiver;
+                const action_data* _act = nullptr;
+                std::vector<name>* _notified = nullptr;
+                std::vector<action_data>* _inline = nullptr;
+                action_trace* _trace = nullptr;
+                // RAM billed per account by the running action, checked when it returns
+                std::map<uint64_t, int64_t> _ram_deltas;
+                chain* _previous = nullptr;
+        };
+    }
+}
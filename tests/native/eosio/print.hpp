@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "native.hpp"
+
+namespace eosio {
+
+    namespace detail {
+        template<typename T, typename = void>
+        struct has_to_string : std::false_type {};
+
+        template<typename T>
+        struct has_to_string<T, std::void_t<decltype( std::declval<const T&>().to_string() )>> : std::true_type {};
+
+        template<typename T>
+        void print_one(std::string& out, const T& v) {
+            if constexpr ( std::is_same_v<T, bool> ) {
+                out += v ? "true" : "false";
+            } else if constexpr ( std::is_same_v<T, char> ) {
+                out += v;
+            } else if constexpr ( std::is_arithmetic_v<T> ) {
+                out += std::to_string( v );
+            } else if constexpr ( std::is_convertible_v<const T&, std::string_view> ) {
+                out += std::string_view( v );
+            } else if constexpr ( has_to_string<T>::value ) {
+                out += v.to_string();
+            } else {
+                static_assert( has_to_string<T>::value, "type cannot be printed" );
+            }
+        }
+    }
+
+    // appends to the console of the running action
+    template<typename... Args>
+    void print(Args&&... args) {
+        std::string out;
+        ( detail::print_one( out, args ), ... );
+        native::chain::current().print( out );
+    }
+}
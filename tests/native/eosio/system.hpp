@@ -0,0 +1,11 @@
+#pragma once
+
+#include "native.hpp"
+#include "time.hpp"
+
+namespace eosio {
+
+    inline time_point current_time_point() { return native::chain::current().now(); }
+
+    inline time_point_sec current_time_point_sec() { return time_point_sec( current_time_point() ); }
+}
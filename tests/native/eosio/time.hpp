@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+    class microseconds {
+        public:
+            explicit microseconds(int64_t c = 0) : _count( c ) {}
+
+            int64_t count() const { return _count; }
+            int64_t to_seconds() const { return _count / 1000000; }
+
+            friend bool operator==(const microseconds& a, const microseconds& b) { return a._count == b._count; }
+            friend bool operator<(const microseconds& a, const microseconds& b) { return a._count < b._count; }
+
+            int64_t _count;
+    };
+
+    inline microseconds seconds(int64_t s) { return microseconds( s * 1000000 ); }
+
+    class time_point {
+        public:
+            explicit time_point(microseconds e = microseconds()) : elapsed( e ) {}
+
+            const microseconds& time_since_epoch() const { return elapsed; }
+            uint32_t sec_since_epoch() const { return uint32_t( elapsed.count() / 1000000 ); }
+
+            time_point operator+(const microseconds& m) const { return time_point( microseconds( elapsed.count() + m.count() ) ); }
+            friend bool operator<(const time_point& a, const time_point& b) { return a.elapsed < b.elapsed; }
+            friend bool operator==(const time_point& a, const time_point& b) { return a.elapsed == b.elapsed; }
+
+            microseconds elapsed;
+
+            template<typename DataStream>
+            friend DataStream& operator<<(DataStream& ds, const time_point& t) { return ds << t.elapsed._count; }
+
+            template<typename DataStream>
+            friend DataStream& operator>>(DataStream& ds, time_point& t) { return ds >> t.elapsed._count; }
+    };
+
+    class time_point_sec {
+        public:
+            time_point_sec() : utc_seconds( 0 ) {}
+            explicit time_point_sec(uint32_t seconds) : utc_seconds( seconds ) {}
+            time_point_sec(const time_point& t) : utc_seconds( uint32_t( t.time_since_epoch().count() / 1000000ll ) ) {}
+
+            static time_point_sec maximum() { return time_point_sec( 0xffffffff ); }
+            static time_point_sec min() { return time_point_sec( 0 ); }
+
+            operator time_point() const { return time_point( eosio::seconds( utc_seconds ) ); }
+            uint32_t sec_since_epoch() const { return utc_seconds; }
+
+            friend time_point_sec operator+(const time_point_sec& t, uint32_t offset) { return time_point_sec( t.utc_seconds + offset ); }
+            friend time_point_sec operator-(const time_point_sec& t, uint32_t offset) { return time_point_sec( t.utc_seconds - offset ); }
+            time_point_sec& operator+=(uint32_t m) { utc_seconds += m; return *this; }
+
+            friend bool operator==(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds == b.utc_seconds; }
+            friend bool operator!=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds != b.utc_seconds; }
+            friend bool operator<(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds < b.utc_seconds; }
+            friend bool operator<=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds <= b.utc_seconds; }
+            friend bool operator>(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds > b.utc_seconds; }
+            friend bool operator>=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds >= b.utc_seconds; }
+
+            uint32_t utc_seconds;
+
+            template<typename DataStream>
+            friend DataStream& operator<<(DataStream& ds, const time_point_sec& t) { return ds << t.utc_seconds; }
+
+            template<typename DataStream>
+            friend DataStream& operator>>(DataStream& ds, time_point_sec& t) { return ds >> t.utc_seconds; }
+    };
+}
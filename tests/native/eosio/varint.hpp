@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace eosio {
+
+    // serialized as a varuint32
+    struct unsigned_int {
+        uint32_t value = 0;
+
+        unsigned_int(uint32_t v = 0) : value( v ) {}
+
+        template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+        unsigned_int(T v) : value( v ) {}
+
+        operator uint32_t() const { return value; }
+
+        unsigned_int& operator=(uint32_t v) { value = v; return *this; }
+
+        friend bool operator==(const unsigned_int& a, const unsigned_int& b) { return a.value == b.value; }
+        friend bool operator!=(const unsigned_int& a, const unsigned_int& b) { return a.value != b.value; }
+        friend bool operator<(const unsigned_int& a, const unsigned_int& b) { return a.value < b.value; }
+
+        template<typename DataStream>
+        friend DataStream& operator<<(DataStream& ds, const unsigned_int& v) {
+            uint64_t val = v.value;
+            do {
+                uint8_t b = uint8_t( val ) & 0x7f;
+                val >>= 7;
+                b |= ( ( val > 0 ) << 7 );
+                ds.write( reinterpret_cast<const char*>( &b ), 1 );
+            } while ( val );
+            return ds;
+        }
+
+        template<typename DataStream>
+        friend DataStream& operator>>(DataStream& ds, unsigned_int& vi) {
+            uint64_t v = 0;
+            char b = 0;
+            uint8_t by = 0;
+            do {
+                ds.get( b );
+                v |= uint32_t( uint8_t( b ) & 0x7f ) << by;
+                by += 7;
+            } while ( uint8_t( b ) & 0x80 );
+            vi.value = static_cast<uint32_t>( v );
+            return ds;
+        }
+    };
+}
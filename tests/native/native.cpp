@@ -0,0 +1,297 @@
+#include <eosio/native.hpp>
+
+namespace eosio::native {
+
+    static chain* current_chain = nullptr;
+
+    chain::chain() : _previous( current_chain ) {
+        current_chain = this;
+    }
+
+    chain::~chain() {
+        current_chain = _previous;
+    }
+
+    chain& chain::current() {
+        check( current_chain != nullptr, "no chain to run the action on" );
+        return *current_chain;
+    }
+
+    void chain::create_account(name account) {
+        check( !is_account( account ), "account " + account.to_string() + " already exists" );
+        _accounts.insert( account.value );
+    }
+
+    std::vector<action_trace> chain::push_transaction(const std::vector<action_data>& actions) {
+        std::vector<action_trace> traces;
+        _undo.clear();
+        try {
+            for ( const auto& act: actions ) {
+                execute( act, traces, 0 );
+            }
+        } catch ( ... ) {
+            for ( auto itr = _undo.rbegin(); itr != _undo.rend(); ++itr ) {
+                ( *itr )();
+            }
+            _undo.clear();
+            throw;
+        }
+        _undo.clear();
+        return traces;
+    }
+
+    // nodeos runs the action on its account and then on every account it notified, the inline
+    // actions sent by any of them run afterwards in the order they were sent
+    void chain::execute(const action_data& act, std::vector<action_trace>& traces, int depth) {
+        check( depth <= 4, "max inline action depth per transaction reached" );
+        std::vector<name> notified{ act.account };
+        std::vector<action_data> inline_actions;
+        for ( size_t i = 0; i < notified.size(); i++ ) {
+            apply( act, notified[i], notified, inline_actions, traces );
+        }
+        for ( const auto& inline_act: inline_actions ) {
+            execute( inline_act, traces, depth + 1 );
+        }
+    }
+
+    void chain::apply(const action_data& act, name receiver, std::vector<name>& notified,
+                      std::vector<action_data>& inline_actions, std::vector<action_trace>& traces) {
+        struct restore {
+            chain& c;
+            name receiver;
+            const action_data* act;
+            std::vector<name>* notified;
+            std::vector<action_data>* inline_actions;
+            action_trace* trace;
+            std::map<uint64_t, int64_t> ram_deltas;
+
+            ~restore() {
+                c._receiver = receiver;
+                c._act = act;
+                c._notified = notified;
+                c._inline = inline_actions;
+                c._trace = trace;
+                c._ram_deltas = std::move( ram_deltas );
+            }
+        } saved{ *this, _receiver, _act, _notified, _inline, _trace, std::move( _ram_deltas ) };
+
+        traces.push_back( { receiver, act, {}, {} } );
+        _receiver = receiver;
+        _act = &act;
+        _notified = &notified;
+        _inline = &inline_actions;
+        _trace = &traces.back();
+        _ram_deltas.clear();
+
+        auto handler = _code.find( receiver.value );
+        if ( handler != _code.end() ) {
+            handler->second( receiver.value, act.account.value, act.name.value );
+        }
+
+        // like nodeos only the net change of the action is checked, an account other than the
+        // receiver has to authorize any increase and cannot be billed at all by a notification
+        for ( const auto& [account, delta]: _ram_deltas ) {
+            if ( delta <= 0 || account == receiver.value ) {
+                continue;
+            }
+            check( receiver == act.account, "cannot charge RAM to other accounts during notify" );
+            check( has_auth( name( account ) ),
+                   "unprivileged contract cannot increase RAM usage of another account that has not authorized the action: " +
+                   name( account ).to_string() );
+        }
+    }
+
+    bool chain::has_auth(name account) const {
+        if ( _act == nullptr ) return false;
+        for ( const auto& auth: _act->authorization ) {
+            if ( auth.actor == account ) return true;
+        }
+        return false;
+    }
+
+    void chain::require_auth(name account) const {
+        check( has_auth( account ), "missing authority of " + account.to_string() );
+    }
+
+    void chain::require_recipient(name account) {
+        check( is_account( account ), "can only notify existing accounts, " + account.to_string() + " does not exist" );
+        for ( const auto& n: *_notified ) {
+            if ( n == account ) return;
+        }
+        _notified->push_back( account );
+    }
+
+    // an inline action carries the authority of the contract sending it through eosio.code, or
+    // authority the running action already has
+    void chain::send_inline(action_data act) {
+        check( is_account( act.account ), "inline action's code account " + act.account.to_string() + " does not exist" );
+        for ( const auto& auth: act.authorization ) {
+            check( auth.actor == _receiver || has_auth( auth.actor ), "missing authority of " + auth.actor.to_string() );
+        }
+        _inline->push_back( std::move( act ) );
+    }
+
+    void chain::set_action_return_value(const char* data, size_t size) {
+        _trace->return_value.assign( data, data + size );
+    }
+
+    void chain::print(const std::string& s) {
+        if ( _trace != nullptr ) {
+            _trace->console += s;
+        }
+    }
+
+    void chain::bill(name payer, int64_t delta) {
+        if ( delta == 0 ) return;
+        _ram[payer.value] += delta;
+        if ( _act != nullptr ) {
+            _ram_deltas[payer.value] += delta;
+        }
+        _undo.push_back( [this, account = payer.value, delta]() { _ram[account] -= delta; } );
+    }
+
+    const table* chain::find_table(const table_key& key) const {
+        auto itr = _tables.find( key );
+        return itr == _tables.end() ? nullptr : &itr->second;
+    }
+
+    const row* chain::db_get(const table_key& key, uint64_t primary) {
+        _counters.reads++;
+        auto t = _tables.find( key );
+        if ( t == _tables.end() ) return nullptr;
+        auto r = t->second.rows.find( primary );
+        if ( r == t->second.rows.end() ) return nullptr;
+        _counters.bytes_read += r->second.data.size();
+        return &r->second;
+    }
+
+    std::optional<uint64_t> chain::db_lower_bound(const table_key& key, uint64_t primary, bool upper) {
+        _counters.reads++;
+        auto t = _tables.find( key );
+        if ( t == _tables.end() ) return std::nullopt;
+        auto r = upper ? t->second.rows.upper_bound( primary ) : t->second.rows.lower_bound( primary );
+        if ( r == t->second.rows.end() ) return std::nullopt;
+        return r->first;
+    }
+
+    std::optional<uint64_t> chain::db_previous(const table_key& key, uint64_t primary) {
+        _counters.reads++;
+        auto t = _tables.find( key );
+        if ( t == _tables.end() ) return std::nullopt;
+        auto r = t->second.rows.lower_bound( primary );
+        if ( r == t->second.rows.begin() ) return std::nullopt;
+        return ( --r )->first;
+    }
+
+    std::optional<uint64_t> chain::db_last(const table_key& key) {
+        _counters.reads++;
+        auto t = _tables.find( key );
+        if ( t == _tables.end() || t->second.rows.empty() ) return std::nullopt;
+        return t->second.rows.rbegin()->first;
+    }
+
+    void chain::acquire_table(const table_key& key, name payer) {
+        auto& t = _table_ids[key];
+        if ( t.count == 0 ) {
+            t.payer = payer;
+            bill( payer, table_overhead );
+        }
+        t.count++;
+        _undo.push_back( [this, key]() {
+            auto itr = _table_ids.find( key );
+            if ( --itr->second.count == 0 ) {
+                _table_ids.erase( itr );
+            }
+        });
+    }
+
+    void chain::release_table(const table_key& key) {
+        auto itr = _table_ids.find( key );
+        auto saved = itr->second;
+        if ( --itr->second.count == 0 ) {
+            bill( saved.payer, -table_overhead );
+            _table_ids.erase( itr );
+        }
+        _undo.push_back( [this, key, saved]() { _table_ids[key] = saved; } );
+    }
+
+    void chain::db_store(const table_key& key, name payer, uint64_t primary, std::vector<char> data) {
+        check( payer.value != 0, "must specify a valid account to pay for new record" );
+        _counters.writes++;
+        _counters.bytes_written += data.size();
+        auto& t = _tables[key];
+        check( t.rows.count( primary ) == 0, "could not insert object, most likely a uniqueness constraint was violated" );
+        acquire_table( key, payer );
+        bill( payer, row_overhead + int64_t( data.size() ) );
+        t.rows[primary] = { std::move( data ), payer };
+        auto rows = &t.rows;
+        _undo.push_back( [rows, primary]() { rows->erase( primary ); } );
+    }
+
+    void chain::db_update(const table_key& key, name payer, uint64_t primary, std::vector<char> data) {
+        _counters.writes++;
+        _counters.bytes_written += data.size();
+        auto t = _tables.find( key );
+        check( t != _tables.end() && t->second.rows.count( primary ) > 0, "dereference of deleted object" );
+        auto& r = t->second.rows[primary];
+        auto old = r;
+        if ( payer.value == 0 ) {
+            payer = old.payer;
+        }
+        if ( payer != old.payer ) {
+            bill( old.payer, -( row_overhead + int64_t( old.data.size() ) ) );
+            bill( payer, row_overhead + int64_t( data.size() ) );
+        } else {
+            bill( payer, int64_t( data.size() ) - int64_t( old.data.size() ) );
+        }
+        r = { std::move( data ), payer };
+        auto rows = &t->second.rows;
+        _undo.push_back( [rows, primary, old]() { ( *rows )[primary] = old; } );
+    }
+
+    void chain::db_remove(const table_key& key, uint64_t primary) {
+        _counters.erases++;
+        auto t = _tables.find( key );
+        check( t != _tables.end() && t->second.rows.count( primary ) > 0, "dereference of deleted object" );
+        auto rows = &t->second.rows;
+        auto old = ( *rows )[primary];
+        bill( old.payer, -( row_overhead + int64_t( old.data.size() ) ) );
+        rows->erase( primary );
+        release_table( key );
+        _undo.push_back( [rows, primary, old]() { ( *rows )[primary] = old; } );
+    }
+
+    void chain::raw_store(const table_key& key, name payer, uint64_t primary, std::vector<char> data) {
+        auto& t = _tables[key];
+        check( t.rows.count( primary ) == 0, "could not insert object, most likely a uniqueness constraint was violated" );
+        acquire_table( key, payer );
+        bill( payer, row_overhead + int64_t( data.size() ) );
+        t.rows[primary] = { std::move( data ), payer };
+    }
+
+    chain::table_usage chain::usage(name code, name table) const {
+        table_usage result;
+        for ( const auto& [key, t]: _tables ) {
+            if ( key.code != code.value || key.table != table.value ) continue;
+            for ( const auto& [primary, r]: t.rows ) {
+                result.rows++;
+                result.data_bytes += r.data.size();
+                result.billed_bytes += row_overhead + int64_t( r.data.size() );
+            }
+        }
+        // secondary index tables carry the table name with the index number in its last four bits
+        for ( const auto& [key, idx]: _indices ) {
+            if ( key.code != code.value || ( key.table & 0xFFFFFFFFFFFFFFF0ULL ) != table.value ) continue;
+            result.billed_bytes += idx->billed_bytes();
+        }
+        for ( const auto& [key, t]: _table_ids ) {
+            if ( key.code != code.value || ( key.table & 0xFFFFFFFFFFFFFFF0ULL ) != table.value ) continue;
+            result.billed_bytes += table_overhead;
+        }
+        return result;
+    }
+}
+
+extern "C" void set_action_return_value(void* return_value, size_t size) {
+    eosio::native::chain::current().set_action_return_value( static_cast<const char*>( return_value ), size );
+}
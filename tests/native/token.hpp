@@ -0,0 +1,45 @@
+#pragma once
+
+// create, issue and transfer of eosio.token, enough to pay for asks on the native chain
+
+#include <eosio/asset.hpp>
+#include <eosio/eosio.hpp>
+
+#include <string>
+
+namespace native_token {
+
+    using namespace eosio;
+
+    class token : public contract {
+        public:
+            using contract::contract;
+
+            void create(const name& issuer, const asset& maximum_supply);
+            void issue(const name& to, const asset& quantity, const std::string& memo);
+            void transfer(const name& from, const name& to, const asset& quantity, const std::string& memo);
+
+            struct account {
+                asset balance;
+
+                uint64_t primary_key() const { return balance.symbol.code().raw(); }
+            };
+
+            struct currency_stats {
+                asset supply;
+                asset max_supply;
+                name  issuer;
+
+                uint64_t primary_key() const { return supply.symbol.code().raw(); }
+            };
+
+            typedef multi_index<"accounts"_n, account> accounts;
+            typedef multi_index<"stat"_n, currency_stats> stats;
+
+        private:
+            void sub_balance(const name& owner, const asset& value);
+            void add_balance(const name& owner, const asset& value, const name& ram_payer);
+    };
+
+    void apply(uint64_t receiver, uint64_t code, uint64_t action);
+}
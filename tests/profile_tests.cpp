@@ -0,0 +1,18 @@
+#include <gtest/gtest.h>
+
+#include "tester.hpp"
+
+namespace {
+
+    // built with DGOODS_PROFILE, every action prints its totals to the console
+    TEST( profile, actions_print_counters ) {
+        tester t;
+        t.create( "tickets"_n, "gold"_n, false, 1000 );
+        auto traces = t.push( tester::contract, "issue"_n, { tester::issuer }, "alice"_n, "tickets"_n, "gold"_n,
+                              tester::units( 2 ), string(), string() );
+
+        const auto& console = traces.front().console;
+        EXPECT_NE( console.find( "issue: finds " ), std::string::npos ) << console;
+        EXPECT_NE( console.find( " emplaces " ), std::string::npos ) << console;
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+// dgoods deployed on the native chain next to eosio.token, with typed helpers for its actions so
+// every argument is packed with the type of the action parameter
+
+#include <dgoods.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "native/token.hpp"
+
+extern "C" void apply(uint64_t receiver, uint64_t code, uint64_t action);
+
+class tester {
+    public:
+        static constexpr name contract = "dgoods"_n;
+        static constexpr name token_contract = "eosio.token"_n;
+        static constexpr name issuer = "issuer"_n;
+        static constexpr name partner = "partner"_n;
+
+        native::chain chain;
+
+        tester() {
+            for ( auto account: { contract, token_contract, issuer, partner, "alice"_n, "bob"_n, "carol"_n, "dave"_n } ) {
+                chain.create_account( account );
+            }
+            chain.set_code( contract, ::apply );
+            chain.set_code( token_contract, native_token::apply );
+            chain.set_now( time_point( seconds( 1600000000 ) ) );
+
+            push( token_contract, "create"_n, { token_contract }, token_contract, eos( 1000000000000 ) );
+            push( token_contract, "issue"_n, { token_contract }, token_contract, eos( 1000000000000 ), string() );
+            push( contract, "setconfig"_n, { contract }, symbol_code( "DGOODS" ), string( "2.0" ) );
+        }
+
+        static asset eos(int64_t amount) { return asset( amount, symbol( symbol_code( "EOS" ), 4 ) ); }
+        static asset units(int64_t amount, uint8_t precision = 0) { return asset( amount, symbol( symbol_code( "DGOODS" ), precision ) ); }
+
+        template<typename... Args>
+        std::vector<native::action_trace> push(name account, name action, std::vector<name> auths, const Args&... args) {
+            native::action_data act{ account, action, {}, pack( std::make_tuple( args... ) ) };
+            for ( auto auth: auths ) {
+                act.authorization.push_back( { auth, "active"_n } );
+            }
+            return chain.push_transaction( { act } );
+        }
+
+        // message of the check that failed, empty when the action succeeded
+        template<typename... Args>
+        std::string error(name account, name action, std::vector<name> auths, const Args&... args) {
+            try {
+                push( account, action, auths, args... );
+            } catch ( const eosio::assertion_failure& e ) {
+                return e.what();
+            }
+            return "";
+        }
+
+        template<typename R, typename... Args>
+        R query(name action, const Args&... args) {
+            auto traces = push( contract, action, {}, args... );
+            return unpack<R>( traces.front().return_value );
+        }
+
+        // tokens
+
+        void fund(name account, int64_t amount) {
+            push( token_contract, "transfer"_n, { token_contract }, token_contract, account, eos( amount ), string( "deposit" ) );
+        }
+
+        int64_t eos_balance(name account) {
+            auto row = find<native_token::token::account>( token_contract, "accounts"_n, account.value, symbol_code( "EOS" ).raw() );
+            return row ? row->balance.amount : 0;
+        }
+
+        void create(name category, name token_name, bool fungible, int64_t max_supply, double rev_split = 0.05,
+                    bool burnable = true, bool sellable = true, bool transferable = true, uint8_t precision = 0) {
+            push( contract, "create"_n, { contract }, issuer, partner, category, token_name, fungible, burnable, sellable,
+                  transferable, rev_split, string( "https://dgoods.io/" ), units( max_supply, precision ) );
+        }
+
+        void issue(name to, name category, name token_name, int64_t amount, const string& relative_uri = "", uint8_t precision = 0) {
+            push( contract, "issue"_n, { issuer }, to, category, token_name, units( amount, precision ), relative_uri, string() );
+        }
+
+        void issuerange(name to, name category, name token_name, int64_t amount, const string& relative_uri = "") {
+            push( contract, "issuerange"_n, { issuer }, to, category, token_name, units( amount ), relative_uri, string() );
+        }
+
+        void transfernft(name from, name to, const std::vector<uint64_t>& ids) {
+            push( contract, "transfernft"_n, { from }, from, to, ids, string() );
+        }
+
+        void burnnft(name owner, const std::vector<uint64_t>& ids) {
+            push( contract, "burnnft"_n, { owner }, owner, ids );
+        }
+
+        void listsale(name seller, const std::vector<uint64_t>& ids, int64_t amount) {
+            push( contract, "listsalenft"_n, { seller }, seller, ids, eos( amount ) );
+        }
+
+        void buy(name buyer, uint64_t batch_id, int64_t amount) {
+            push( token_contract, "transfer"_n, { buyer }, buyer, contract, eos( amount ),
+                  std::to_string( batch_id ) + "," + buyer.to_string() );
+        }
+
+        // from_serial of the next call, empty once done
+        std::optional<uint64_t> burntype(name category, name token_name, uint64_t from_serial, uint64_t max_rows) {
+            auto traces = push( contract, "burntype"_n, { issuer }, category, token_name, from_serial, max_rows );
+            return unpack<std::optional<uint64_t>>( traces.front().return_value );
+        }
+
+        // from_serial of the next call, empty once done
+        std::optional<uint64_t> seturis(name category, name token_name, const string& relative_uri, uint64_t from_serial,
+                                        uint64_t max_rows) {
+            auto traces = push( contract, "seturis"_n, { issuer }, category, token_name, relative_uri, from_serial, max_rows );
+            return unpack<std::optional<uint64_t>>( traces.front().return_value );
+        }
+
+        void migrate(uint64_t max_rows) {
+            push( contract, "migrate"_n, { contract }, max_rows );
+        }
+
+        // tables of dgoods, or of another contract
+
+        template<typename T>
+        std::optional<T> find(name code, name table, uint64_t scope, uint64_t primary) {
+            auto t = chain.find_table( { code.value, scope, table.value } );
+            if ( t == nullptr ) return std::nullopt;
+            auto r = t->rows.find( primary );
+            if ( r == t->rows.end() ) return std::nullopt;
+            return unpack<T>( r->second.data );
+        }
+
+        template<typename T>
+        std::optional<T> find(name table, uint64_t scope, uint64_t primary) {
+            return find<T>( contract, table, scope, primary );
+        }
+
+        template<typename T>
+        std::vector<T> rows(name table, uint64_t scope) {
+            std::vector<T> result;
+            auto t = chain.find_table( { contract.value, scope, table.value } );
+            if ( t == nullptr ) return result;
+            for ( const auto& [primary, r]: t->rows ) {
+                result.push_back( unpack<T>( r.data ) );
+            }
+            return result;
+        }
+
+        std::optional<dgoods::nft> nft(uint64_t id) { return find<dgoods::nft>( "nft"_n, contract.value, id ); }
+
+        int64_t balance(name owner, uint64_t category_name_id) {
+            auto row = find<dgoods::balances>( "balances"_n, owner.value, category_name_id );
+            return row ? row->amount : 0;
+        }
+
+        dgoods::dgoodstats stats(name category, name token_name) {
+            return *find<dgoods::dgoodstats>( "dgoodstats"_n, category.value, token_name.value );
+        }
+
+        // writes a row as an older version of the contract did, bypassing indices it did not have
+        template<typename T>
+        void store(name table, uint64_t scope, uint64_t primary, const T& row, name payer = contract) {
+            chain.raw_store( { contract.value, scope, table.value }, payer, primary, pack( row ) );
+        }
+};
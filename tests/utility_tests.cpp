@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <utility.hpp>
+
+using namespace utility;
+
+namespace {
+
+    // message of the check parsememo failed, empty when it parsed
+    std::string memo_error(string_view memo) {
+        try {
+            parsememo( memo );
+        } catch ( const eosio::assertion_failure& e ) {
+            return e.what();
+        }
+        return "";
+    }
+
+    TEST( parsememo, reads_batch_and_account ) {
+        EXPECT_EQ( parsememo( "12,alice" ), make_tuple( uint64_t( 12 ), "alice"_n ) );
+        EXPECT_EQ( parsememo( " 12 , alice " ), make_tuple( uint64_t( 12 ), "alice"_n ) );
+        EXPECT_EQ( parsememo( "18446744073709551615,bob" ), make_tuple( numeric_limits<uint64_t>::max(), "bob"_n ) );
+    }
+
+    TEST( parsememo, empty_memo ) {
+        EXPECT_EQ( memo_error( "" ), "malformed memo: must have batch_id,to_account" );
+    }
+
+    TEST( parsememo, missing_delimiter ) {
+        EXPECT_EQ( memo_error( "12" ), "malformed memo: must have batch_id,to_account" );
+        EXPECT_EQ( memo_error( "alice" ), "malformed memo: must have batch_id,to_account" );
+    }
+
+    TEST( parsememo, trailing_delimiter ) {
+        EXPECT_EQ( memo_error( "12," ), "malformed memo: must have batch_id,to_account" );
+        EXPECT_EQ( memo_error( "12,  " ), "malformed memo: must have batch_id,to_account" );
+    }
+
+    TEST( parsememo, leading_delimiter ) {
+        EXPECT_EQ( memo_error( ",alice" ), "malformed memo: batch_id must be a number" );
+    }
+
+    TEST( parsememo, bad_batch_id ) {
+        EXPECT_EQ( memo_error( "1x,alice" ), "malformed memo: batch_id must be a number" );
+        EXPECT_EQ( memo_error( "-1,alice" ), "malformed memo: batch_id must be a number" );
+        EXPECT_EQ( memo_error( "18446744073709551616,alice" ), "malformed memo: batch_id too large" );
+    }
+}
@@ -0,0 +1,413 @@
+// deterministic mix of create, issue, transfer, list, buy and burn actions on the native chain,
+// owners and token types drawn from Zipf distributions so a few accounts and types hold most
+// tokens. Every report_every actions it prints the wall time percentiles and mean db calls of each
+// action over the last interval and the RAM billed per row of every table, so costs can be followed
+// as the data set grows. The same seed and options always push the same actions.
+//
+//   dgoods_workload --actions=1000000 --accounts=100000 --types=2000 --report_every=100000
+//   dgoods_workload --mix=issue:30,transfer:40,list:10,buy:10,burn:10,create:0
+//   dgoods_workload --uris=10000
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tester.hpp"
+
+namespace {
+
+    enum action_type { CREATE, ISSUE, TRANSFER, LIST, BUY, BURN, ACTION_TYPES };
+    const char* const action_names[ACTION_TYPES] = { "create", "issue", "transfer", "list", "buy", "burn" };
+
+    struct options {
+        uint64_t seed = 1;
+        uint64_t actions = 100000;
+        uint64_t accounts = 1000;
+        uint64_t types = 100;
+        double zipf = 1.1;
+        uint64_t report_every = 10000;
+        uint64_t max_issue = 10;
+        // distinct relative_uris issue draws from, none when 0
+        uint64_t uris = 0;
+        // relative weights of the actions
+        double mix[ACTION_TYPES] = { 1, 20, 40, 15, 10, 14 };
+    };
+
+    void usage() {
+        std::fprintf( stderr, "usage: dgoods_workload [--seed=N] [--actions=N] [--accounts=N] [--types=N] [--zipf=S]\n"
+                              "                       [--report_every=N] [--max_issue=N] [--uris=N] [--mix=action:weight,...]\n" );
+        std::exit( 2 );
+    }
+
+    options parse(int argc, char** argv) {
+        options opts;
+        for ( int i = 1; i < argc; i++ ) {
+            std::string arg = argv[i];
+            auto eq = arg.find( '=' );
+            if ( arg.rfind( "--", 0 ) != 0 || eq == std::string::npos ) usage();
+            std::string key = arg.substr( 2, eq - 2 );
+            std::string value = arg.substr( eq + 1 );
+            if ( key == "seed" ) opts.seed = std::stoull( value );
+            else if ( key == "actions" ) opts.actions = std::stoull( value );
+            else if ( key == "accounts" ) opts.accounts = std::stoull( value );
+            else if ( key == "types" ) opts.types = std::stoull( value );
+            else if ( key == "zipf" ) opts.zipf = std::stod( value );
+            else if ( key == "report_every" ) opts.report_every = std::stoull( value );
+            else if ( key == "max_issue" ) opts.max_issue = std::min<uint64_t>( std::stoull( value ), 100 );
+            else if ( key == "uris" ) opts.uris = std::stoull( value );
+            else if ( key == "mix" ) {
+                std::fill( std::begin( opts.mix ), std::end( opts.mix ), 0 );
+                size_t start = 0;
+                while ( start < value.size() ) {
+                    auto end = value.find( ',', start );
+                    if ( end == std::string::npos ) end = value.size();
+                    auto entry = value.substr( start, end - start );
+                    auto colon = entry.find( ':' );
+                    if ( colon == std::string::npos ) usage();
+                    auto type = std::find( std::begin( action_names ), std::end( action_names ), entry.substr( 0, colon ) );
+                    if ( type == std::end( action_names ) ) usage();
+                    opts.mix[type - std::begin( action_names )] = std::stod( entry.substr( colon + 1 ) );
+                    start = end + 1;
+                }
+            } else {
+                usage();
+            }
+        }
+        if ( opts.accounts == 0 || opts.types == 0 || opts.report_every == 0 || opts.max_issue == 0 ) usage();
+        return opts;
+    }
+
+    // mt19937_64 is the same on every platform, the std distributions are not, so draws are made here
+    class generator {
+        public:
+            explicit generator(uint64_t seed) : _engine( seed ) {}
+
+            // uniform in [0, 1)
+            double real() { return ( _engine() >> 11 ) * ( 1.0 / 9007199254740992.0 ); }
+            // uniform in [0, n)
+            uint64_t below(uint64_t n) { return _engine() % n; }
+
+        private:
+            std::mt19937_64 _engine;
+    };
+
+    // rank 0 is the most likely, rank k has weight 1 / (k + 1)^s
+    class zipf {
+        public:
+            zipf(uint64_t n, double s) : _cdf( n ) {
+                double total = 0;
+                for ( uint64_t k = 0; k < n; k++ ) {
+                    total += 1.0 / std::pow( double( k + 1 ), s );
+                    _cdf[k] = total;
+                }
+                for ( auto& c: _cdf ) c /= total;
+            }
+
+            // rank among the first n
+            uint64_t draw(generator& rng, uint64_t n) {
+                double u = rng.real() * _cdf[n - 1];
+                return std::upper_bound( _cdf.begin(), _cdf.begin() + n, u ) - _cdf.begin();
+            }
+
+        private:
+            std::vector<double> _cdf;
+    };
+
+    // a distinct account name for every index, 12 characters of a-z
+    name make_name(char prefix, uint64_t index) {
+        std::string s( 1, prefix );
+        for ( int i = 0; i < 11; i++ ) {
+            s.push_back( 'a' + index % 26 );
+            index /= 26;
+        }
+        return name( s );
+    }
+
+    struct sample {
+        double micros;
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t erases;
+        int64_t ram;
+    };
+
+    // tokens the workload believes each account holds, kept in step with the contract so every
+    // action it pushes is valid
+    struct model {
+        std::vector<std::vector<uint64_t>> owned;
+        // dgood_id to owner index and position in owned
+        std::unordered_map<uint64_t, std::pair<uint64_t, size_t>> tokens;
+        // dgood_ids listed, each alone so its batch_id is its id
+        std::vector<uint64_t> listed;
+        std::unordered_map<uint64_t, size_t> listed_pos;
+        std::vector<std::pair<name, name>> types;
+
+        void add(uint64_t owner, uint64_t id) {
+            tokens[id] = { owner, owned[owner].size() };
+            owned[owner].push_back( id );
+        }
+
+        void remove(uint64_t id) {
+            auto [owner, pos] = tokens.at( id );
+            auto& ids = owned[owner];
+            tokens[ids.back()].second = pos;
+            ids[pos] = ids.back();
+            ids.pop_back();
+            tokens.erase( id );
+        }
+
+        void list(uint64_t id) {
+            listed_pos[id] = listed.size();
+            listed.push_back( id );
+        }
+
+        void unlist(uint64_t id) {
+            auto pos = listed_pos.at( id );
+            listed_pos[listed.back()] = pos;
+            listed[pos] = listed.back();
+            listed.pop_back();
+            listed_pos.erase( id );
+        }
+
+        bool is_listed(uint64_t id) const { return listed_pos.count( id ) > 0; }
+    };
+
+    class workload {
+        public:
+            explicit workload(const options& opts)
+                : _opts( opts ), _rng( opts.seed ), _owners( opts.accounts, opts.zipf ), _types( opts.types, opts.zipf ) {
+                _model.owned.resize( opts.accounts );
+                for ( uint64_t i = 0; i < opts.accounts; i++ ) {
+                    _accounts.push_back( make_name( 'u', i ) );
+                    _t.chain.create_account( _accounts.back() );
+                }
+                // every type needs one before anything can be issued
+                _create();
+            }
+
+            void run() {
+                double total_weight = 0;
+                for ( auto w: _opts.mix ) total_weight += w;
+                if ( total_weight <= 0 ) usage();
+
+                for ( uint64_t n = 1; n <= _opts.actions; n++ ) {
+                    double u = _rng.real() * total_weight;
+                    int type = 0;
+                    while ( type < ACTION_TYPES - 1 && u >= _opts.mix[type] ) {
+                        u -= _opts.mix[type];
+                        type++;
+                    }
+                    _step( action_type( type ) );
+                    if ( n % _opts.report_every == 0 || n == _opts.actions ) {
+                        _report( n );
+                    }
+                }
+            }
+
+        private:
+            options _opts;
+            generator _rng;
+            zipf _owners;
+            zipf _types;
+            tester _t;
+            model _model;
+            std::vector<name> _accounts;
+            std::vector<sample> _samples[ACTION_TYPES];
+            uint64_t _skipped[ACTION_TYPES] = {};
+            uint64_t _failed[ACTION_TYPES] = {};
+
+            uint64_t _owner() { return _owners.draw( _rng, _accounts.size() ); }
+
+            // a token of the owner drawn, or none after a few owners without an unlisted one
+            std::optional<uint64_t> _token(uint64_t& owner) {
+                for ( int attempt = 0; attempt < 8; attempt++ ) {
+                    owner = _owner();
+                    const auto& ids = _model.owned[owner];
+                    if ( ids.empty() ) continue;
+                    auto id = ids[_rng.below( ids.size() )];
+                    if ( !_model.is_listed( id ) ) return id;
+                }
+                return std::nullopt;
+            }
+
+            uint64_t _next_id() {
+                auto config = _t.find<dgoods::tokenconfigs>( "tokenconfigs"_n, tester::contract.value, "tokenconfigs"_n.value );
+                return config && config->next_dgood_id.has_value() ? config->next_dgood_id.value() : 0;
+            }
+
+            template<typename F>
+            bool _measure(action_type type, F&& push) {
+                _t.chain.reset_counters();
+                int64_t ram = _t.chain.total_ram();
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    push();
+                } catch ( const eosio::assertion_failure& e ) {
+                    if ( _failed[type]++ == 0 ) {
+                        std::fprintf( stderr, "%s failed: %s\n", action_names[type], e.what() );
+                    }
+                    return false;
+                }
+                auto end = std::chrono::steady_clock::now();
+                const auto& c = _t.chain.counters();
+                _samples[type].push_back( { std::chrono::duration<double, std::micro>( end - start ).count(),
+                                            c.reads, c.writes, c.erases, _t.chain.total_ram() - ram } );
+                return true;
+            }
+
+            void _create() {
+                auto index = _model.types.size();
+                // a handful of categories, each with many token names
+                name category = make_name( 'c', index % 16 );
+                name token_name = make_name( 't', index );
+                bool created = _measure( CREATE, [&]() {
+                    _t.create( category, token_name, false, 1000000000000 );
+                });
+                if ( created ) _model.types.push_back( { category, token_name } );
+            }
+
+            void _step(action_type type) {
+                switch ( type ) {
+                    case CREATE: {
+                        if ( _model.types.size() >= _opts.types ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        _create();
+                        return;
+                    }
+                    case ISSUE: {
+                        auto owner = _owner();
+                        const auto& [category, token_name] = _model.types[_types.draw( _rng, _model.types.size() )];
+                        int64_t amount = 1 + _rng.below( _opts.max_issue );
+                        string uri = _opts.uris ? "item/" + std::to_string( _rng.below( _opts.uris ) ) + ".json" : "";
+                        uint64_t first = _next_id();
+                        if ( _measure( type, [&]() { _t.issue( _accounts[owner], category, token_name, amount, uri ); } ) ) {
+                            for ( uint64_t id = first; id < _next_id(); id++ ) _model.add( owner, id );
+                        }
+                        return;
+                    }
+                    case TRANSFER: {
+                        uint64_t from;
+                        auto id = _token( from );
+                        auto to = _owner();
+                        if ( !id || to == from ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        if ( _measure( type, [&]() { _t.transfernft( _accounts[from], _accounts[to], { *id } ); } ) ) {
+                            _model.remove( *id );
+                            _model.add( to, *id );
+                        }
+                        return;
+                    }
+                    case LIST: {
+                        uint64_t seller;
+                        auto id = _token( seller );
+                        if ( !id ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        int64_t price = 200 + _rng.below( 100000 );
+                        if ( _measure( type, [&]() { _t.listsale( _accounts[seller], { *id }, price ); } ) ) {
+                            _model.list( *id );
+                        }
+                        return;
+                    }
+                    case BUY: {
+                        auto buyer = _owner();
+                        if ( _model.listed.empty() ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        auto id = _model.listed[_rng.below( _model.listed.size() )];
+                        auto seller = _model.tokens.at( id ).first;
+                        if ( seller == buyer ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        auto ask = *_t.find<dgoods::asks>( "asks"_n, tester::contract.value, id );
+                        // buyers are funded as they need it, outside of the measured action
+                        if ( _t.eos_balance( _accounts[buyer] ) < ask.amount.amount ) {
+                            _t.fund( _accounts[buyer], 10000000 );
+                        }
+                        if ( _measure( type, [&]() { _t.buy( _accounts[buyer], id, ask.amount.amount ); } ) ) {
+                            _model.unlist( id );
+                            _model.remove( id );
+                            _model.add( buyer, id );
+                        }
+                        return;
+                    }
+                    case BURN: {
+                        uint64_t owner;
+                        auto id = _token( owner );
+                        if ( !id ) {
+                            _skipped[type]++;
+                            return;
+                        }
+                        if ( _measure( type, [&]() { _t.burnnft( _accounts[owner], { *id } ); } ) ) {
+                            _model.remove( *id );
+                        }
+                        return;
+                    }
+                    default:
+                        return;
+                }
+            }
+
+            static double percentile(std::vector<double>& sorted, double p) {
+                if ( sorted.empty() ) return 0;
+                size_t i = std::min( sorted.size() - 1, size_t( p * sorted.size() ) );
+                return sorted[i];
+            }
+
+            void _report(uint64_t actions) {
+                std::printf( "\n== after %llu actions: %zu tokens, %zu listed, %zu types\n",
+                             (unsigned long long) actions, _model.tokens.size(), _model.listed.size(), _model.types.size() );
+                std::printf( "%-9s %8s %8s %8s %9s %9s %9s %9s %7s %7s %7s %8s\n", "action", "count", "skipped", "failed",
+                             "p50_us", "p90_us", "p99_us", "max_us", "reads", "writes", "erases", "ram" );
+                for ( int type = 0; type < ACTION_TYPES; type++ ) {
+                    auto& samples = _samples[type];
+                    std::vector<double> micros;
+                    double reads = 0, writes = 0, erases = 0, ram = 0;
+                    for ( const auto& s: samples ) {
+                        micros.push_back( s.micros );
+                        reads += s.reads;
+                        writes += s.writes;
+                        erases += s.erases;
+                        ram += s.ram;
+                    }
+                    std::sort( micros.begin(), micros.end() );
+                    double n = std::max<size_t>( samples.size(), 1 );
+                    std::printf( "%-9s %8zu %8llu %8llu %9.2f %9.2f %9.2f %9.2f %7.1f %7.1f %7.1f %8.1f\n", action_names[type],
+                                 samples.size(), (unsigned long long) _skipped[type], (unsigned long long) _failed[type],
+                                 percentile( micros, 0.5 ), percentile( micros, 0.9 ), percentile( micros, 0.99 ),
+                                 micros.empty() ? 0 : micros.back(), reads / n, writes / n, erases / n, ram / n );
+                    samples.clear();
+                    _skipped[type] = 0;
+                    _failed[type] = 0;
+                }
+
+                std::printf( "%-12s %10s %14s %14s %10s\n", "table", "rows", "data_bytes", "billed_bytes", "per_row" );
+                for ( auto table: { "nft"_n, "dgoodranges"_n, "balances"_n, "asks"_n, "uris"_n, "dgoodstats"_n, "typestats"_n,
+                                    "tokentypes"_n, "categoryinfo"_n, "proceeds"_n } ) {
+                    auto usage = _t.chain.usage( tester::contract, table );
+                    std::printf( "%-12s %10llu %14lld %14lld %10.1f\n", table.to_string().c_str(), (unsigned long long) usage.rows,
+                                 (long long) usage.data_bytes, (long long) usage.billed_bytes,
+                                 usage.rows ? double( usage.billed_bytes ) / usage.rows : 0.0 );
+                }
+                std::fflush( stdout );
+            }
+    };
+}
+
+int main(int argc, char** argv) {
+    workload( parse( argc, argv ) ).run();
+    return 0;
+}
@@ -0,0 +1,414 @@
+#include "decoder.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace decoder {
+
+    namespace {
+
+        constexpr char dump_magic[8] = "DGDUMP1";
+        constexpr size_t record_header = sizeof(uint64_t) + sizeof(uint32_t);
+
+        [[noreturn]] void fail_errno(const std::string& what, const std::string& path) {
+            throw decode_error( what + " " + path + ": " + std::strerror( errno ) );
+        }
+
+        std::string fixed_string(const char* chars, size_t size) {
+            return std::string( chars, strnlen( chars, size ) );
+        }
+
+        void copy_fixed(char* to, size_t size, const std::string& from, const char* what) {
+            if ( from.size() >= size ) {
+                throw decode_error( std::string( what ) + " " + from + " is too long" );
+            }
+            std::memset( to, 0, size );
+            std::memcpy( to, from.data(), from.size() );
+        }
+
+        uint64_t align(uint64_t offset) { return ( offset + 63 ) & ~uint64_t( 63 ); }
+
+    }
+
+    const char* reader::take(size_t size) {
+        if ( size_t( end - pos ) < size ) {
+            throw decode_error( "row ends before its layout" );
+        }
+        const char* at = pos;
+        pos += size;
+        return at;
+    }
+
+    uint32_t reader::varuint32() {
+        uint32_t value = 0;
+        for ( int shift = 0; shift < 35; shift += 7 ) {
+            uint8_t b = fixed<uint8_t>();
+            value |= uint32_t( b & 0x7f ) << shift;
+            if ( !( b & 0x80 ) ) return value;
+        }
+        throw decode_error( "varuint32 longer than 5 bytes" );
+    }
+
+    std::string_view reader::string() {
+        uint32_t size = varuint32();
+        return std::string_view( take( size ), size );
+    }
+
+    dgood_row dgood_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        dgood_row row;
+        row.id = r.fixed<uint64_t>();
+        row.serial_number = r.fixed<uint64_t>();
+        row.owner = r.fixed<uint64_t>();
+        row.category = r.fixed<uint64_t>();
+        row.token_name = r.fixed<uint64_t>();
+        if ( r.boolean() ) {
+            row.relative_uri = r.string();
+        }
+        return row;
+    }
+
+    accounts_row accounts_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        accounts_row row;
+        row.category_name_id = r.fixed<uint64_t>();
+        row.category = r.fixed<uint64_t>();
+        row.token_name = r.fixed<uint64_t>();
+        row.amount = read_asset( r );
+        return row;
+    }
+
+    dgoodstats_row dgoodstats_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        dgoodstats_row row;
+        row.fungible = r.boolean();
+        row.burnable = r.boolean();
+        row.sellable = r.boolean();
+        row.transferable = r.boolean();
+        row.issuer = r.fixed<uint64_t>();
+        row.rev_partner = r.fixed<uint64_t>();
+        row.token_name = r.fixed<uint64_t>();
+        row.category_name_id = r.fixed<uint64_t>();
+        row.max_supply = read_asset( r );
+        row.current_supply = read_asset( r );
+        row.issued_supply = read_asset( r );
+        row.rev_split = r.fixed<double>();
+        row.base_uri = r.string();
+        row.rev_split_bps = r.extension<uint16_t>();
+        row.holder_count = r.extension<uint64_t>();
+        return row;
+    }
+
+    asks_row asks_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        asks_row row;
+        row.batch_id = r.fixed<uint64_t>();
+        uint32_t count = r.varuint32();
+        row.dgood_ids = u64_list( r.take( size_t( count ) * sizeof(uint64_t) ), count );
+        row.seller = r.fixed<uint64_t>();
+        row.amount = read_asset( r );
+        row.expiration = r.fixed<uint32_t>();
+        row.category_name_id = r.extension<uint64_t>();
+        return row;
+    }
+
+    tokenconfigs_row tokenconfigs_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        tokenconfigs_row row;
+        row.standard = r.fixed<uint64_t>();
+        row.version = r.string();
+        row.symbol = r.fixed<uint64_t>();
+        row.category_name_id = r.fixed<uint64_t>();
+        row.next_dgood_id = r.extension<uint64_t>();
+        if ( r.more() ) {
+            row.accrue_proceeds = r.boolean();
+        }
+        return row;
+    }
+
+    nft_row nft_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        nft_row row;
+        row.id = r.fixed<uint64_t>();
+        row.serial_number = r.varuint32();
+        row.owner = r.fixed<uint64_t>();
+        row.category_name_id = r.varuint32();
+        row.lock = r.varuint32();
+        row.uri_id = r.varuint32();
+        return row;
+    }
+
+    dgoodranges_row dgoodranges_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        dgoodranges_row row;
+        row.last_id = r.fixed<uint64_t>();
+        row.first_id = r.fixed<uint64_t>();
+        row.serial_number = r.varuint32();
+        row.owner = r.fixed<uint64_t>();
+        row.category_name_id = r.varuint32();
+        row.uri_id = r.varuint32();
+        return row;
+    }
+
+    uris_row uris_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        uris_row row;
+        row.uri_id = r.fixed<uint64_t>();
+        row.uri = r.string();
+        row.hash = r.fixed<uint64_t>();
+        row.refs = r.fixed<uint64_t>();
+        return row;
+    }
+
+    balances_row balances_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        balances_row row;
+        row.category_name_id = r.varuint32();
+        row.amount = r.fixed<int64_t>();
+        return row;
+    }
+
+    tokentypes_row tokentypes_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        tokentypes_row row;
+        row.category_name_id = r.fixed<uint64_t>();
+        row.category = r.fixed<uint64_t>();
+        row.token_name = r.fixed<uint64_t>();
+        return row;
+    }
+
+    typestats_row typestats_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        typestats_row row;
+        row.category_name_id = r.fixed<uint64_t>();
+        row.fungible = r.boolean();
+        row.burnable = r.boolean();
+        row.sellable = r.boolean();
+        row.transferable = r.boolean();
+        row.holders_tracked = r.boolean();
+        row.rev_partner = r.fixed<uint64_t>();
+        row.rev_split_bps = r.fixed<uint16_t>();
+        row.supply_symbol = r.fixed<uint64_t>();
+        return row;
+    }
+
+    holders_row holders_row::decode(const char* data, size_t size) {
+        reader r( data, size );
+        holders_row row;
+        row.owner = r.fixed<uint64_t>();
+        row.amount = r.fixed<int64_t>();
+        return row;
+    }
+
+    mapped_file::mapped_file(const std::string& path) {
+        int fd = ::open( path.c_str(), O_RDONLY );
+        if ( fd < 0 ) fail_errno( "cannot open", path );
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 ) {
+            ::close( fd );
+            fail_errno( "cannot stat", path );
+        }
+        length = st.st_size;
+        if ( length > 0 ) {
+            void* p = ::mmap( nullptr, length, PROT_READ, MAP_SHARED, fd, 0 );
+            if ( p == MAP_FAILED ) {
+                ::close( fd );
+                fail_errno( "cannot map", path );
+            }
+            base = static_cast<char*>( p );
+            // read front to back by every slice
+            ::madvise( base, length, MADV_SEQUENTIAL );
+        }
+        ::close( fd );
+    }
+
+    mapped_file::mapped_file(const std::string& path, size_t size) {
+        int fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if ( fd < 0 ) fail_errno( "cannot create", path );
+        if ( ::ftruncate( fd, size ) != 0 ) {
+            ::close( fd );
+            fail_errno( "cannot resize", path );
+        }
+        length = size;
+        if ( length > 0 ) {
+            void* p = ::mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+            if ( p == MAP_FAILED ) {
+                ::close( fd );
+                fail_errno( "cannot map", path );
+            }
+            base = static_cast<char*>( p );
+        }
+        ::close( fd );
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept : base( other.base ), length( other.length ) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+        std::swap( base, other.base );
+        std::swap( length, other.length );
+        return *this;
+    }
+
+    mapped_file::~mapped_file() {
+        if ( base ) ::munmap( base, length );
+    }
+
+    dump::dump(const std::string& path) : file( path ) {
+        const char* data = file.data();
+        size_t size = file.size();
+        if ( size < sizeof(dump_magic) + 16 || std::memcmp( data, dump_magic, sizeof(dump_magic) ) != 0 ) {
+            throw decode_error( path + " is not a row dump" );
+        }
+        table_name = fixed_string( data + sizeof(dump_magic), 16 );
+        for ( size_t at = sizeof(dump_magic) + 16; at < size; ) {
+            uint32_t row_size;
+            if ( size - at < record_header ) {
+                throw decode_error( path + " ends inside a record" );
+            }
+            std::memcpy( &row_size, data + at + sizeof(uint64_t), sizeof(uint32_t) );
+            if ( size - at - record_header < row_size ) {
+                throw decode_error( path + " ends inside a record" );
+            }
+            offsets.push_back( at );
+            at += record_header + row_size;
+        }
+    }
+
+    uint64_t dump::scope(uint64_t i) const {
+        uint64_t value;
+        std::memcpy( &value, file.data() + offsets[i], sizeof(uint64_t) );
+        return value;
+    }
+
+    std::string_view dump::row(uint64_t i) const {
+        const char* record = file.data() + offsets[i];
+        uint32_t size;
+        std::memcpy( &size, record + sizeof(uint64_t), sizeof(uint32_t) );
+        return std::string_view( record + record_header, size );
+    }
+
+    dump_writer::dump_writer(const std::string& path, const std::string& table) {
+        file = std::fopen( path.c_str(), "wb" );
+        if ( file == nullptr ) fail_errno( "cannot create", path );
+        char name[16];
+        copy_fixed( name, sizeof(name), table, "table" );
+        std::fwrite( dump_magic, 1, sizeof(dump_magic), file );
+        std::fwrite( name, 1, sizeof(name), file );
+    }
+
+    dump_writer::~dump_writer() {
+        if ( file ) std::fclose( file );
+    }
+
+    void dump_writer::add(uint64_t scope, const char* data, uint32_t size) {
+        std::fwrite( &scope, 1, sizeof(scope), file );
+        std::fwrite( &size, 1, sizeof(size), file );
+        std::fwrite( data, 1, size, file );
+    }
+
+    void dump_writer::close() {
+        bool failed = std::ferror( file ) != 0;
+        failed |= std::fclose( file ) != 0;
+        file = nullptr;
+        if ( failed ) {
+            throw decode_error( "cannot write row dump" );
+        }
+    }
+
+    void schema_sink::add(const char* name, column_type type, uint32_t width) {
+        column_header c{};
+        copy_fixed( c.name, sizeof(c.name), name, "column" );
+        c.type = type;
+        c.width = width;
+        columns.push_back( c );
+    }
+
+    void schema_sink::bytes(const char* name, std::string_view) {
+        add( name, column_type::offsets, sizeof(uint64_t) );
+        add( ( std::string( name ) + ".data" ).c_str(), column_type::bytes, 1 );
+    }
+
+    void schema_sink::list(const char* name, const u64_list&) {
+        add( name, column_type::offsets, sizeof(uint64_t) );
+        add( ( std::string( name ) + ".data" ).c_str(), column_type::u64, sizeof(uint64_t) );
+    }
+
+    void write_sink::elements(const char* data, uint64_t count, uint32_t width) {
+        const auto& offsets = columns[column++];
+        const auto& values = columns[column++];
+        uint64_t& cursor = cursors[var++];
+        std::memcpy( base + offsets.offset + row * sizeof(uint64_t), &cursor, sizeof(uint64_t) );
+        std::memcpy( base + values.offset + cursor * width, data, count * width );
+        cursor += count;
+    }
+
+    mapped_file create_columns(const std::string& path, const std::string& table, uint64_t rows,
+                               std::vector<column_header>& columns, const std::vector<uint64_t>& elements) {
+        file_header header{};
+        std::memcpy( header.magic, columns_magic, sizeof(columns_magic) );
+        copy_fixed( header.table, sizeof(header.table), table, "table" );
+        header.rows = rows;
+        header.columns = columns.size();
+
+        uint64_t offset = align( sizeof(header) + columns.size() * sizeof(column_header) );
+        size_t var = 0;
+        bool values = false;
+        for ( auto& c: columns ) {
+            // the column after offsets has the elements
+            if ( values ) {
+                c.count = elements[var++];
+            } else {
+                c.count = c.type == column_type::offsets ? rows + 1 : rows;
+            }
+            values = c.type == column_type::offsets;
+            c.offset = offset;
+            offset = align( offset + c.count * c.width );
+        }
+
+        mapped_file file( path, offset );
+        std::memcpy( file.data(), &header, sizeof(header) );
+        std::memcpy( file.data() + sizeof(header), columns.data(), columns.size() * sizeof(column_header) );
+        return file;
+    }
+
+    column_file::column_file(const std::string& path) : file( path ) {
+        if ( file.size() < sizeof(file_header) || std::memcmp( file.data(), columns_magic, sizeof(columns_magic) ) != 0 ) {
+            throw decode_error( path + " is not a columnar file" );
+        }
+        const auto& h = header();
+        if ( file.size() < sizeof(file_header) + h.columns * sizeof(column_header) ) {
+            throw decode_error( path + " ends inside its column headers" );
+        }
+        headers.resize( h.columns );
+        std::memcpy( headers.data(), file.data() + sizeof(file_header), h.columns * sizeof(column_header) );
+        for ( const auto& c: headers ) {
+            if ( c.offset + c.count * c.width > file.size() ) {
+                throw decode_error( path + " ends inside column " + fixed_string( c.name, sizeof(c.name) ) );
+            }
+        }
+    }
+
+    std::string column_file::table() const {
+        return fixed_string( header().table, sizeof(header().table) );
+    }
+
+    const column_header& column_file::find(const std::string& name) const {
+        for ( const auto& c: headers ) {
+            if ( fixed_string( c.name, sizeof(c.name) ) == name ) return c;
+        }
+        throw decode_error( "no column " + name );
+    }
+
+    std::string_view column_file::string(const std::string& name, uint64_t row) const {
+        const uint64_t* offsets = column<uint64_t>( name );
+        const char* data = column<char>( name + ".data" );
+        return std::string_view( data + offsets[row], offsets[row + 1] - offsets[row] );
+    }
+
+}
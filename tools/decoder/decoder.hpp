@@ -0,0 +1,659 @@
+#pragma once
+
+// reads dgoods table rows on the host without eosio.cdt. Rows are decoded in place from the bytes
+// of a row dump, in the EOSLIB_SERIALIZE order of include/dgoods.hpp: strings and vectors are views
+// into the dump and nothing is allocated per row. A dump is scanned by several threads at once and
+// can be exported to a columnar file, whose columns are arrays that are used straight from a
+// mapping of the file. Integers are little endian, as on chain, so is the host assumed to be.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace decoder {
+
+    // a row shorter than its layout, or a file that is not a dump or columnar file
+    struct decode_error : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // the fields of one serialized row, in order
+    class reader {
+        public:
+            reader(const char* data, size_t size) : pos( data ), end( data + size ) {}
+
+            bool more() const { return pos < end; }
+
+            template<typename T>
+            T fixed() {
+                static_assert( std::is_trivially_copyable_v<T> );
+                T value;
+                std::memcpy( &value, take( sizeof(T) ), sizeof(T) );
+                return value;
+            }
+
+            bool boolean() { return fixed<uint8_t>() != 0; }
+            uint32_t varuint32();
+            std::string_view string();
+
+            // a binary_extension is there while the row has bytes left
+            template<typename T>
+            std::optional<T> extension() {
+                if ( !more() ) return std::nullopt;
+                return fixed<T>();
+            }
+
+            const char* take(size_t size);
+
+        private:
+            const char* pos;
+            const char* end;
+    };
+
+    struct asset_view {
+        int64_t amount = 0;
+        uint64_t symbol = 0;
+    };
+
+    // vector<uint64_t> in place, its values are not aligned
+    class u64_list {
+        public:
+            u64_list() = default;
+            u64_list(const char* data, uint32_t count) : data( data ), count( count ) {}
+
+            uint32_t size() const { return count; }
+            const char* bytes() const { return data; }
+            uint64_t operator[](uint32_t i) const {
+                uint64_t value;
+                std::memcpy( &value, data + i * sizeof(uint64_t), sizeof(uint64_t) );
+                return value;
+            }
+
+        private:
+            const char* data = nullptr;
+            uint32_t count = 0;
+    };
+
+    inline asset_view read_asset(reader& r) {
+        asset_view a;
+        a.amount = r.fixed<int64_t>();
+        a.symbol = r.fixed<uint64_t>();
+        return a;
+    }
+
+    // every row type has the name of its table, decode and columns, which passes each field to a
+    // sink in the order of the columnar file: fixed size fields as fixed, strings as bytes and
+    // vectors as list. binary_extension fields are a has_ column and the value, 0 when missing,
+    // varuint32 fields a u32 column.
+
+    struct dgood_row {
+        static constexpr const char* table = "dgood";
+
+        uint64_t id = 0;
+        uint64_t serial_number = 0;
+        uint64_t owner = 0;
+        uint64_t category = 0;
+        uint64_t token_name = 0;
+        std::optional<std::string_view> relative_uri;
+
+        static dgood_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "id", id );
+            s.fixed( "serial_number", serial_number );
+            s.fixed( "owner", owner );
+            s.fixed( "category", category );
+            s.fixed( "token_name", token_name );
+            s.fixed( "has_relative_uri", relative_uri.has_value() );
+            s.bytes( "relative_uri", relative_uri.value_or( std::string_view() ) );
+        }
+    };
+
+    // scope is the owner
+    struct accounts_row {
+        static constexpr const char* table = "accounts";
+
+        uint64_t category_name_id = 0;
+        uint64_t category = 0;
+        uint64_t token_name = 0;
+        asset_view amount;
+
+        static accounts_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "category", category );
+            s.fixed( "token_name", token_name );
+            s.fixed( "amount.amount", amount.amount );
+            s.fixed( "amount.symbol", amount.symbol );
+        }
+    };
+
+    // scope is the category
+    struct dgoodstats_row {
+        static constexpr const char* table = "dgoodstats";
+
+        bool fungible = false;
+        bool burnable = false;
+        bool sellable = false;
+        bool transferable = false;
+        uint64_t issuer = 0;
+        uint64_t rev_partner = 0;
+        uint64_t token_name = 0;
+        uint64_t category_name_id = 0;
+        asset_view max_supply;
+        asset_view current_supply;
+        asset_view issued_supply;
+        double rev_split = 0;
+        std::string_view base_uri;
+        std::optional<uint16_t> rev_split_bps;
+        std::optional<uint64_t> holder_count;
+
+        static dgoodstats_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "fungible", fungible );
+            s.fixed( "burnable", burnable );
+            s.fixed( "sellable", sellable );
+            s.fixed( "transferable", transferable );
+            s.fixed( "issuer", issuer );
+            s.fixed( "rev_partner", rev_partner );
+            s.fixed( "token_name", token_name );
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "max_supply.amount", max_supply.amount );
+            s.fixed( "max_supply.symbol", max_supply.symbol );
+            s.fixed( "current_supply.amount", current_supply.amount );
+            s.fixed( "current_supply.symbol", current_supply.symbol );
+            s.fixed( "issued_supply.amount", issued_supply.amount );
+            s.fixed( "issued_supply.symbol", issued_supply.symbol );
+            s.fixed( "rev_split", rev_split );
+            s.bytes( "base_uri", base_uri );
+            s.fixed( "has_rev_split_bps", rev_split_bps.has_value() );
+            s.fixed( "rev_split_bps", rev_split_bps.value_or( uint16_t( 0 ) ) );
+            s.fixed( "has_holder_count", holder_count.has_value() );
+            s.fixed( "holder_count", holder_count.value_or( 0 ) );
+        }
+    };
+
+    struct asks_row {
+        static constexpr const char* table = "asks";
+
+        uint64_t batch_id = 0;
+        u64_list dgood_ids;
+        uint64_t seller = 0;
+        asset_view amount;
+        uint32_t expiration = 0;
+        std::optional<uint64_t> category_name_id;
+
+        static asks_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "batch_id", batch_id );
+            s.list( "dgood_ids", dgood_ids );
+            s.fixed( "seller", seller );
+            s.fixed( "amount.amount", amount.amount );
+            s.fixed( "amount.symbol", amount.symbol );
+            s.fixed( "expiration", expiration );
+            s.fixed( "has_category_name_id", category_name_id.has_value() );
+            s.fixed( "category_name_id", category_name_id.value_or( 0 ) );
+        }
+    };
+
+    struct tokenconfigs_row {
+        static constexpr const char* table = "tokenconfigs";
+
+        uint64_t standard = 0;
+        std::string_view version;
+        uint64_t symbol = 0;
+        uint64_t category_name_id = 0;
+        std::optional<uint64_t> next_dgood_id;
+        std::optional<bool> accrue_proceeds;
+
+        static tokenconfigs_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "standard", standard );
+            s.bytes( "version", version );
+            s.fixed( "symbol", symbol );
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "has_next_dgood_id", next_dgood_id.has_value() );
+            s.fixed( "next_dgood_id", next_dgood_id.value_or( 0 ) );
+            s.fixed( "has_accrue_proceeds", accrue_proceeds.has_value() );
+            s.fixed( "accrue_proceeds", accrue_proceeds.value_or( false ) );
+        }
+    };
+
+    struct nft_row {
+        static constexpr const char* table = "nft";
+
+        uint64_t id = 0;
+        uint32_t serial_number = 0;
+        uint64_t owner = 0;
+        uint32_t category_name_id = 0;
+        uint32_t lock = 0;
+        uint32_t uri_id = 0;
+
+        static nft_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "id", id );
+            s.fixed( "serial_number", serial_number );
+            s.fixed( "owner", owner );
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "lock", lock );
+            s.fixed( "uri_id", uri_id );
+        }
+    };
+
+    struct dgoodranges_row {
+        static constexpr const char* table = "dgoodranges";
+
+        uint64_t last_id = 0;
+        uint64_t first_id = 0;
+        uint32_t serial_number = 0;
+        uint64_t owner = 0;
+        uint32_t category_name_id = 0;
+        uint32_t uri_id = 0;
+
+        static dgoodranges_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "last_id", last_id );
+            s.fixed( "first_id", first_id );
+            s.fixed( "serial_number", serial_number );
+            s.fixed( "owner", owner );
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "uri_id", uri_id );
+        }
+    };
+
+    struct uris_row {
+        static constexpr const char* table = "uris";
+
+        uint64_t uri_id = 0;
+        std::string_view uri;
+        // first 8 bytes of the sha256 of uri
+        uint64_t hash = 0;
+        uint64_t refs = 0;
+
+        static uris_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "uri_id", uri_id );
+            s.bytes( "uri", uri );
+            s.fixed( "hash", hash );
+            s.fixed( "refs", refs );
+        }
+    };
+
+    // scope is the owner
+    struct balances_row {
+        static constexpr const char* table = "balances";
+
+        uint32_t category_name_id = 0;
+        int64_t amount = 0;
+
+        static balances_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "amount", amount );
+        }
+    };
+
+    struct tokentypes_row {
+        static constexpr const char* table = "tokentypes";
+
+        uint64_t category_name_id = 0;
+        uint64_t category = 0;
+        uint64_t token_name = 0;
+
+        static tokentypes_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "category", category );
+            s.fixed( "token_name", token_name );
+        }
+    };
+
+    struct typestats_row {
+        static constexpr const char* table = "typestats";
+
+        uint64_t category_name_id = 0;
+        bool fungible = false;
+        bool burnable = false;
+        bool sellable = false;
+        bool transferable = false;
+        bool holders_tracked = false;
+        uint64_t rev_partner = 0;
+        uint16_t rev_split_bps = 0;
+        uint64_t supply_symbol = 0;
+
+        static typestats_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "category_name_id", category_name_id );
+            s.fixed( "fungible", fungible );
+            s.fixed( "burnable", burnable );
+            s.fixed( "sellable", sellable );
+            s.fixed( "transferable", transferable );
+            s.fixed( "holders_tracked", holders_tracked );
+            s.fixed( "rev_partner", rev_partner );
+            s.fixed( "rev_split_bps", rev_split_bps );
+            s.fixed( "supply_symbol", supply_symbol );
+        }
+    };
+
+    // scope is the category_name_id
+    struct holders_row {
+        static constexpr const char* table = "holders";
+
+        uint64_t owner = 0;
+        int64_t amount = 0;
+
+        static holders_row decode(const char* data, size_t size);
+
+        template<typename Sink>
+        void columns(Sink& s) const {
+            s.fixed( "owner", owner );
+            s.fixed( "amount", amount );
+        }
+    };
+
+    // a file mapped read only, or read write once resized
+    class mapped_file {
+        public:
+            mapped_file() = default;
+            explicit mapped_file(const std::string& path);
+            // creates or truncates path to size bytes
+            mapped_file(const std::string& path, size_t size);
+            mapped_file(mapped_file&& other) noexcept;
+            mapped_file& operator=(mapped_file&& other) noexcept;
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+            ~mapped_file();
+
+            char* data() const { return base; }
+            size_t size() const { return length; }
+
+        private:
+            char* base = nullptr;
+            size_t length = 0;
+    };
+
+    // rows of one table as {uint64 scope, uint32 size, row} records after a header naming the
+    // table, written by dump_writer from a snapshot or state history feed
+    class dump {
+        public:
+            explicit dump(const std::string& path);
+
+            const std::string& table() const { return table_name; }
+            uint64_t size() const { return offsets.size(); }
+            uint64_t scope(uint64_t i) const;
+            std::string_view row(uint64_t i) const;
+
+        private:
+            mapped_file file;
+            std::string table_name;
+            // of every record, read once when the dump is opened
+            std::vector<uint64_t> offsets;
+    };
+
+    class dump_writer {
+        public:
+            dump_writer(const std::string& path, const std::string& table);
+            dump_writer(const dump_writer&) = delete;
+            dump_writer& operator=(const dump_writer&) = delete;
+            ~dump_writer();
+
+            void add(uint64_t scope, const char* data, uint32_t size);
+            void add(uint64_t scope, const std::vector<char>& row) { add( scope, row.data(), row.size() ); }
+            void close();
+
+        private:
+            std::FILE* file;
+    };
+
+    // number of slices parallel cuts rows into
+    inline unsigned slices(unsigned threads, uint64_t rows) {
+        return unsigned( std::max<uint64_t>( 1, std::min<uint64_t>( threads, rows ) ) );
+    }
+
+    // runs f(slice, begin, end) on every slice of [0, rows), one thread each, returns once all are
+    // done and rethrows the first exception of a slice
+    template<typename F>
+    void parallel(unsigned threads, uint64_t rows, F&& f) {
+        threads = slices( threads, rows );
+        std::vector<std::exception_ptr> errors( threads );
+        auto slice = [&]( unsigned t ) {
+            try {
+                f( t, rows * t / threads, rows * ( t + 1 ) / threads );
+            } catch ( ... ) {
+                errors[t] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        for ( unsigned t = 1; t < threads; t++ ) {
+            workers.emplace_back( slice, t );
+        }
+        slice( 0 );
+        for ( auto& w: workers ) {
+            w.join();
+        }
+        for ( auto& e: errors ) {
+            if ( e ) std::rethrow_exception( e );
+        }
+    }
+
+    // calls f(scope, row) for every row of the dump, from threads threads, each on its own slice
+    template<typename Row, typename F>
+    void scan(const dump& d, unsigned threads, F&& f) {
+        if ( d.table() != Row::table ) {
+            throw decode_error( "dump of " + d.table() + " read as " + Row::table );
+        }
+        parallel( threads, d.size(), [&]( unsigned, uint64_t begin, uint64_t end ) {
+            for ( uint64_t i = begin; i < end; i++ ) {
+                auto data = d.row( i );
+                f( d.scope( i ), Row::decode( data.data(), data.size() ) );
+            }
+        });
+    }
+
+    // columnar file: header, then column headers, then the columns at 64 byte aligned offsets.
+    // The first column is scope. A string or vector field is two columns, name with the rows + 1
+    // offsets of every row's first element in name.data, and name.data with the elements.
+    enum class column_type : uint32_t { u8 = 1, u16, u32, u64, i64, f64, offsets, bytes };
+
+    struct file_header {
+        char magic[8];
+        char table[16];
+        uint64_t rows;
+        uint32_t columns;
+        uint32_t reserved;
+    };
+
+    struct column_header {
+        char name[32];
+        column_type type;
+        uint32_t width;
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    constexpr char columns_magic[8] = "DGCOLS1";
+
+    template<typename T>
+    constexpr column_type type_of() {
+        if constexpr ( std::is_same_v<T, bool> || std::is_same_v<T, uint8_t> ) return column_type::u8;
+        else if constexpr ( std::is_same_v<T, uint16_t> ) return column_type::u16;
+        else if constexpr ( std::is_same_v<T, uint32_t> ) return column_type::u32;
+        else if constexpr ( std::is_same_v<T, uint64_t> ) return column_type::u64;
+        else if constexpr ( std::is_same_v<T, int64_t> ) return column_type::i64;
+        else {
+            static_assert( std::is_same_v<T, double> );
+            return column_type::f64;
+        }
+    }
+
+    // names and types of the columns of a row type, scope first
+    struct schema_sink {
+        std::vector<column_header> columns;
+
+        void add(const char* name, column_type type, uint32_t width);
+        template<typename T>
+        void fixed(const char* name, T) { add( name, type_of<T>(), sizeof(T) ); }
+        void bytes(const char* name, std::string_view);
+        void list(const char* name, const u64_list&);
+    };
+
+    // elements of every string and vector column of a slice of rows
+    struct size_sink {
+        std::vector<uint64_t> elements;
+        size_t column = 0;
+
+        template<typename T>
+        void fixed(const char*, T) {}
+        void bytes(const char*, std::string_view value) { elements[column++] += value.size(); }
+        void list(const char*, const u64_list& value) { elements[column++] += value.size(); }
+    };
+
+    // writes the columns of row into the mapped file
+    struct write_sink {
+        char* base;
+        const std::vector<column_header>& columns;
+        // next element of every string and vector column
+        std::vector<uint64_t>& cursors;
+        uint64_t row = 0;
+        size_t column = 0;
+        size_t var = 0;
+
+        template<typename T>
+        void fixed(const char*, T value) {
+            const auto& c = columns[column++];
+            std::memcpy( base + c.offset + row * sizeof(T), &value, sizeof(T) );
+        }
+        void bytes(const char*, std::string_view value) { elements( value.data(), value.size(), 1 ); }
+        void list(const char*, const u64_list& value) { elements( value.bytes(), value.size(), sizeof(uint64_t) ); }
+
+        void elements(const char* data, uint64_t count, uint32_t width);
+    };
+
+    // lays out the columns of rows rows and elements elements per string and vector column and
+    // maps path at its final size with the headers written
+    mapped_file create_columns(const std::string& path, const std::string& table, uint64_t rows,
+                               std::vector<column_header>& columns, const std::vector<uint64_t>& elements);
+
+    struct export_stats {
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+    };
+
+    // decodes every row twice, first to size the string and vector columns, then to write them
+    template<typename Row>
+    export_stats export_columns(const dump& d, const std::string& path, unsigned threads) {
+        if ( d.table() != Row::table ) {
+            throw decode_error( "dump of " + d.table() + " read as " + Row::table );
+        }
+        schema_sink schema;
+        schema.fixed( "scope", uint64_t( 0 ) );
+        Row().columns( schema );
+        size_t vars = 0;
+        for ( const auto& c: schema.columns ) {
+            vars += c.type == column_type::offsets;
+        }
+
+        uint64_t rows = d.size();
+        threads = slices( threads, rows );
+        std::vector<std::vector<uint64_t>> slice_elements( threads );
+        parallel( threads, rows, [&]( unsigned t, uint64_t begin, uint64_t end ) {
+            size_sink s{ std::vector<uint64_t>( vars ) };
+            for ( uint64_t i = begin; i < end; i++ ) {
+                auto data = d.row( i );
+                s.column = 0;
+                Row::decode( data.data(), data.size() ).columns( s );
+            }
+            slice_elements[t] = std::move( s.elements );
+        });
+
+        // every slice starts writing where the previous one ends
+        std::vector<uint64_t> elements( vars );
+        std::vector<std::vector<uint64_t>> slice_cursors( threads );
+        for ( unsigned t = 0; t < threads; t++ ) {
+            slice_cursors[t] = elements;
+            for ( size_t v = 0; v < vars; v++ ) {
+                elements[v] += slice_elements[t][v];
+            }
+        }
+        auto file = create_columns( path, Row::table, rows, schema.columns, elements );
+
+        parallel( threads, rows, [&]( unsigned t, uint64_t begin, uint64_t end ) {
+            write_sink s{ file.data(), schema.columns, slice_cursors[t] };
+            for ( uint64_t i = begin; i < end; i++ ) {
+                auto data = d.row( i );
+                s.row = i;
+                s.column = 0;
+                s.var = 0;
+                s.fixed( "scope", d.scope( i ) );
+                Row::decode( data.data(), data.size() ).columns( s );
+            }
+        });
+        // the offsets after the last row
+        size_t v = 0;
+        for ( const auto& c: schema.columns ) {
+            if ( c.type != column_type::offsets ) continue;
+            std::memcpy( file.data() + c.offset + rows * sizeof(uint64_t), &elements[v++], sizeof(uint64_t) );
+        }
+        return { rows, file.size() };
+    }
+
+    // a columnar file mapped read only, columns are arrays into the mapping
+    class column_file {
+        public:
+            explicit column_file(const std::string& path);
+
+            std::string table() const;
+            uint64_t rows() const { return header().rows; }
+            const std::vector<column_header>& columns() const { return headers; }
+
+            template<typename T>
+            const T* column(const std::string& name) const {
+                const auto& c = find( name );
+                if ( c.width != sizeof(T) ) {
+                    throw decode_error( "column " + name + " has values of " + std::to_string( c.width ) + " bytes" );
+                }
+                return reinterpret_cast<const T*>( file.data() + c.offset );
+            }
+
+            // value of a string column in row
+            std::string_view string(const std::string& name, uint64_t row) const;
+
+        private:
+            const file_header& header() const { return *reinterpret_cast<const file_header*>( file.data() ); }
+            const column_header& find(const std::string& name) const;
+
+            mapped_file file;
+            std::vector<column_header> headers;
+    };
+
+}
@@ -0,0 +1,60 @@
+// writes the columnar file of a row dump of dgood, accounts, dgoodstats, asks, tokenconfigs, nft,
+// dgoodranges, uris, balances, tokentypes, typestats or holders
+//
+//   dgoods_export dgood.dump dgood.columns --threads=8
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "decoder.hpp"
+
+using namespace decoder;
+
+int main(int argc, char** argv) {
+    std::string paths[2];
+    int given = 0;
+    unsigned threads = std::thread::hardware_concurrency();
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        if ( arg.rfind( "--threads=", 0 ) == 0 ) {
+            threads = std::stoul( arg.substr( 10 ) );
+        } else if ( given < 2 ) {
+            paths[given++] = arg;
+        } else {
+            given = 3;
+        }
+    }
+    if ( given != 2 ) {
+        std::fprintf( stderr, "usage: %s <dump> <columns> [--threads=n]\n", argv[0] );
+        return 2;
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        dump d( paths[0] );
+        const auto& table = d.table();
+        export_stats stats;
+        if ( table == dgood_row::table ) stats = export_columns<dgood_row>( d, paths[1], threads );
+        else if ( table == accounts_row::table ) stats = export_columns<accounts_row>( d, paths[1], threads );
+        else if ( table == dgoodstats_row::table ) stats = export_columns<dgoodstats_row>( d, paths[1], threads );
+        else if ( table == asks_row::table ) stats = export_columns<asks_row>( d, paths[1], threads );
+        else if ( table == tokenconfigs_row::table ) stats = export_columns<tokenconfigs_row>( d, paths[1], threads );
+        else if ( table == nft_row::table ) stats = export_columns<nft_row>( d, paths[1], threads );
+        else if ( table == dgoodranges_row::table ) stats = export_columns<dgoodranges_row>( d, paths[1], threads );
+        else if ( table == uris_row::table ) stats = export_columns<uris_row>( d, paths[1], threads );
+        else if ( table == balances_row::table ) stats = export_columns<balances_row>( d, paths[1], threads );
+        else if ( table == tokentypes_row::table ) stats = export_columns<tokentypes_row>( d, paths[1], threads );
+        else if ( table == typestats_row::table ) stats = export_columns<typestats_row>( d, paths[1], threads );
+        else if ( table == holders_row::table ) stats = export_columns<holders_row>( d, paths[1], threads );
+        else throw decode_error( "no layout for table " + table );
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        std::printf( "%s: %llu rows, %llu bytes in %.3f s\n", table.c_str(), (unsigned long long)stats.rows,
+                     (unsigned long long)stats.bytes, seconds );
+    } catch ( const std::exception& e ) {
+        std::fprintf( stderr, "%s\n", e.what() );
+        return 1;
+    }
+    return 0;
+}